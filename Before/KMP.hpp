@@ -7,14 +7,19 @@
  */
 #ifndef OCTINC_KMP_HPP
 #  define OCTINC_KMP_HPP
-#  ifndef STD_BITS_STDCPP_H>
+#  ifndef STD_BITS_STDCPP_H
 #    define STD_BITS_STDCPP_H
 #    include <bits/stdc++.h>
 #  endif
-void KMPinit(std::string, int*);
-int KMP(std::string, std::string, int*);
-std::vector<int> KMPs(std::string, std::string, int*);
-void KMPinit(std::string a, int *b) {
+void KMPinit(const std::string&, int*);
+int KMP(const std::string&, const std::string&, int*);
+std::vector<int> KMPs(const std::string&, const std::string&, int*);
+inline int KMPskip(const std::string &a, const std::string &b, int i) {
+    // With nothing matched, jump to the next candidate first byte.
+    const void *p = memchr(b.data() + i, a[0], b.length() - i);
+    return p ? (const char *)p - b.data() : b.length();
+}
+void KMPinit(const std::string &a, int *b) {
     int len = a.length();
     b[0] = -1;
     for (int i = 1; i < len; ++i) {
@@ -23,19 +28,21 @@ void KMPinit(std::string a, int *b) {
         b[i] += a[b[i] + 1] == a[i];
     }
 }
-int KMP(std::string a, std::string b, int *c) {
+int KMP(const std::string &a, const std::string &b, int *c) {
     int len1 = a.length(), len2 = b.length(), now = -1;
     for (int i = 0; i < len2; ++i) {
+        if (now == -1 && len1 && (i = KMPskip(a, b, i)) == len2) break;
         while (a[now + 1] != b[i] && now + 1) now = c[now];
         now += a[now + 1] == b[i];
         if (now + 1 == len1) return i - now;
     }
     return -1;
 }
-std::vector<int> KMPs(std::string a, std::string b, int *c) {
+std::vector<int> KMPs(const std::string &a, const std::string &b, int *c) {
     std::vector<int> v;
     int len1 = a.length(), len2 = b.length(), now = -1;
     for (int i = 0; i < len2; ++i) {
+        if (now == -1 && len1 && (i = KMPskip(a, b, i)) == len2) break;
         while (a[now + 1] != b[i] && now + 1) now = c[now];
         now += a[now + 1] == b[i];
         if (now + 1 == len1) {
@@ -12,78 +12,405 @@
 #error "should use C++11 implementation"
 #endif
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
-#include "complex.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "complex.hpp"
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
 
 namespace Octinc {
 namespace detail {
-template <typename __Tp>
-static void __FFT_Rearrange(const complex<__Tp>* const Input,
-                            const complex<__Tp>* Output, const unsigned int N) {
-    unsigned int tar = 0;
+template <bool Inv, typename __Tp>
+size_t __FFT_Simd4(size_t, const __Tp*, const __Tp*, size_t, __Tp*, __Tp*,
+                   size_t, const __Tp*) {
+    return 0;
+}
 
-    for (unsigned int i = 0; i < N; ++i) {
-        Output[tar] = Input[i];
-        unsigned int t = N;
+#ifdef __AVX__
+template <bool Inv>
+size_t __FFT_Simd4(size_t s, const double* xr, const double* xi, size_t xs,
+                   double* yr, double* yi, size_t ys, const double* w) {
+    const __m256d w1r = _mm256_set1_pd(w[0]), w2r = _mm256_set1_pd(w[2]),
+                  w3r = _mm256_set1_pd(w[4]);
+    const __m256d w1i = _mm256_set1_pd(Inv ? -w[1] : w[1]),
+                  w2i = _mm256_set1_pd(Inv ? -w[3] : w[3]),
+                  w3i = _mm256_set1_pd(Inv ? -w[5] : w[5]);
+    size_t q = 0;
 
-        while (tar & (t >>= 1)) tar &= ~t;
+    for (; q + 4 <= s; q += 4) {
+        __m256d ar = _mm256_loadu_pd(xr + q), ai = _mm256_loadu_pd(xi + q);
+        __m256d br = _mm256_loadu_pd(xr + q + xs),
+                bi = _mm256_loadu_pd(xi + q + xs);
+        __m256d cr = _mm256_loadu_pd(xr + q + 2 * xs),
+                ci = _mm256_loadu_pd(xi + q + 2 * xs);
+        __m256d dr = _mm256_loadu_pd(xr + q + 3 * xs),
+                di = _mm256_loadu_pd(xi + q + 3 * xs);
+        __m256d pr = _mm256_add_pd(ar, cr), pi = _mm256_add_pd(ai, ci);
+        __m256d mr = _mm256_sub_pd(ar, cr), mi = _mm256_sub_pd(ai, ci);
+        __m256d sr = _mm256_add_pd(br, dr), si = _mm256_add_pd(bi, di);
+        // j * (b - d), or -j * (b - d) for the inverse.
+        __m256d jr = _mm256_sub_pd(di, bi), ji = _mm256_sub_pd(br, dr);
+
+        if (Inv) {
+            jr = _mm256_sub_pd(_mm256_setzero_pd(), jr);
+            ji = _mm256_sub_pd(_mm256_setzero_pd(), ji);
+        }
 
-        tar |= t;
+        __m256d t1r = _mm256_sub_pd(mr, jr), t1i = _mm256_sub_pd(mi, ji);
+        __m256d t2r = _mm256_sub_pd(pr, sr), t2i = _mm256_sub_pd(pi, si);
+        __m256d t3r = _mm256_add_pd(mr, jr), t3i = _mm256_add_pd(mi, ji);
+
+        _mm256_storeu_pd(yr + q, _mm256_add_pd(pr, sr));
+        _mm256_storeu_pd(yi + q, _mm256_add_pd(pi, si));
+        _mm256_storeu_pd(yr + q + ys, _mm256_sub_pd(_mm256_mul_pd(w1r, t1r),
+                                                    _mm256_mul_pd(w1i, t1i)));
+        _mm256_storeu_pd(yi + q + ys, _mm256_add_pd(_mm256_mul_pd(w1r, t1i),
+                                                    _mm256_mul_pd(w1i, t1r)));
+        _mm256_storeu_pd(
+            yr + q + 2 * ys,
+            _mm256_sub_pd(_mm256_mul_pd(w2r, t2r), _mm256_mul_pd(w2i, t2i)));
+        _mm256_storeu_pd(
+            yi + q + 2 * ys,
+            _mm256_add_pd(_mm256_mul_pd(w2r, t2i), _mm256_mul_pd(w2i, t2r)));
+        _mm256_storeu_pd(
+            yr + q + 3 * ys,
+            _mm256_sub_pd(_mm256_mul_pd(w3r, t3r), _mm256_mul_pd(w3i, t3i)));
+        _mm256_storeu_pd(
+            yi + q + 3 * ys,
+            _mm256_add_pd(_mm256_mul_pd(w3r, t3i), _mm256_mul_pd(w3i, t3r)));
     }
+
+    return q;
 }
+#endif
 
-template <typename __Tp>
-static void __FFT_Rearrange(const complex<__Tp>* Data, const unsigned int N) {
-    unsigned int tar = 0;
+template <bool Inv, typename __Tp>
+void __FFT_Stage4(size_t n, size_t s, const __Tp* xr, const __Tp* xi,
+                  __Tp* yr, __Tp* yi, const __Tp* w) {
+    const size_t m = n >> 2;
 
-    for (unsigned int i = 0; i < N; ++i) {
-        if (tar > i) std::swap(Data[tar], Data[i]);
+    for (size_t p = 0; p < m; ++p, w += 6) {
+        const __Tp *ar = xr + s * p, *ai = xi + s * p;
+        __Tp *zr = yr + s * (p << 2), *zi = yi + s * (p << 2);
+        const __Tp w1r = w[0], w1i = Inv ? -w[1] : w[1];
+        const __Tp w2r = w[2], w2i = Inv ? -w[3] : w[3];
+        const __Tp w3r = w[4], w3i = Inv ? -w[5] : w[5];
+        size_t q = __FFT_Simd4<Inv>(s, ar, ai, s * m, zr, zi, s, w);
 
-        unsigned int t = N;
+        for (; q < s; ++q) {
+            const __Tp a0 = ar[q], a1 = ai[q];
+            const __Tp b0 = ar[q + s * m], b1 = ai[q + s * m];
+            const __Tp c0 = ar[q + 2 * s * m], c1 = ai[q + 2 * s * m];
+            const __Tp d0 = ar[q + 3 * s * m], d1 = ai[q + 3 * s * m];
+            const __Tp pr = a0 + c0, pi = a1 + c1, mr = a0 - c0, mi = a1 - c1;
+            const __Tp sr = b0 + d0, si = b1 + d1;
+            const __Tp jr = Inv ? b1 - d1 : d1 - b1,
+                       ji = Inv ? d0 - b0 : b0 - d0;
+            const __Tp t1r = mr - jr, t1i = mi - ji;
+            const __Tp t2r = pr - sr, t2i = pi - si;
+            const __Tp t3r = mr + jr, t3i = mi + ji;
 
-        while (tar & (t >>= 1)) tar &= ~t;
+            zr[q] = pr + sr, zi[q] = pi + si;
+            zr[q + s] = w1r * t1r - w1i * t1i;
+            zi[q + s] = w1r * t1i + w1i * t1r;
+            zr[q + 2 * s] = w2r * t2r - w2i * t2i;
+            zi[q + 2 * s] = w2r * t2i + w2i * t2r;
+            zr[q + 3 * s] = w3r * t3r - w3i * t3i;
+            zi[q + 3 * s] = w3r * t3i + w3i * t3r;
+        }
+    }
+}
 
-        tar |= t;
+template <typename __Tp>
+void __FFT_Stage2(size_t s, const __Tp* xr, const __Tp* xi, __Tp* yr,
+                  __Tp* yi) {
+    for (size_t q = 0; q < s; ++q) {
+        const __Tp a0 = xr[q], a1 = xi[q], b0 = xr[q + s], b1 = xi[q + s];
+        yr[q] = a0 + b0, yi[q] = a1 + b1;
+        yr[q + s] = a0 - b0, yi[q + s] = a1 - b1;
     }
 }
+}  // namespace detail
 
+namespace FFT {
 template <typename __Tp>
-static void __FFT_Perform(const complex<__Tp>* Data, const unsigned int N,
-                          const bool opt) {
-    const double Pi = opt ? acos(-1.0) : -acos(1.0);
-
-    for (unsigned int i = 1; i < N; i <<= 1) {
-        const double delta = Pi / double(i);
-        const double Sine = sin(delta * 0.5);
-        const complex<__Tp> Mul(static_cast<__Tp>(-2.0 * Sine * Sine),
-                                static_cast<__Tp>(sin(delta)));
-        complex<__Tp> fac(1.0);
-
-        for (unsigned int j = 0; j < i; ++j) {
-            for (unsigned int k = j; k < N; k += (i << 1)) {
-                const unsigned int m = k + i;
-                const complex<__Tp> prod = complex<__Tp>(fac * Data[m]);
-                Data[m] = Data[k] - prod;
-                Data[k] += prod;
-            }
+class plan {
+   private:
+    size_t n;
+    std::vector<size_t> offset;
+    std::vector<__Tp> twiddle;
+
+    plan(const plan&) = delete;
+    plan& operator=(const plan&) = delete;
 
-            fac = Mul * fac + fac;
+    template <bool Inv>
+    void execute(__Tp* re, __Tp* im) const {
+        static thread_local std::vector<__Tp> work;
+
+        if (work.size() < (n << 1)) work.resize(n << 1);
+
+        __Tp *xr = re, *xi = im, *yr = work.data(), *yi = work.data() + n;
+        size_t len = n, s = 1, k = 0;
+
+        for (; len >= 4; len >>= 2, s <<= 2, ++k) {
+            detail::__FFT_Stage4<Inv>(len, s, xr, xi, yr, yi,
+                                      twiddle.data() + offset[k]);
+            std::swap(xr, yr), std::swap(xi, yi);
+        }
+
+        if (len == 2) {
+            detail::__FFT_Stage2(s, xr, xi, yr, yi);
+            std::swap(xr, yr), std::swap(xi, yi);
         }
+
+        if (xr != re) std::copy(xr, xr + n, re), std::copy(xi, xi + n, im);
     }
-}
+
+   public:
+    explicit plan(size_t N) : n(N)
+    /*
+    N has to be a power of 2.
+    */
+    {
+        const long double Pi = acosl(-1.0L);
+
+        for (size_t len = n; len >= 4; len >>= 2) {
+            offset.push_back(twiddle.size());
+
+            for (size_t p = 0; p < (len >> 2); ++p)
+                for (size_t t = 1; t <= 3; ++t) {
+                    long double a = -2 * Pi * (long double)(p * t) / len;
+                    twiddle.push_back(static_cast<__Tp>(cosl(a)));
+                    twiddle.push_back(static_cast<__Tp>(sinl(a)));
+                }
+        }
+    }
+
+    size_t size() const { return n; }
+
+    void forward(__Tp* re, __Tp* im) const
+    /*
+    DFT of n points stored as separate real and imaginary arrays.
+    */
+    {
+        execute<false>(re, im);
+    }
+
+    void inverse(__Tp* re, __Tp* im, bool scale = true) const
+    /*
+    IDFT of n points stored as separate real and imaginary arrays.
+    */
+    {
+        execute<true>(re, im);
+
+        if (!scale) return;
+
+        const __Tp fac = static_cast<__Tp>(1.0 / n);
+
+        for (size_t i = 0; i < n; ++i) re[i] *= fac, im[i] *= fac;
+    }
+
+    void forward(complex<__Tp>* Data) const
+    /*
+    DFT of n complex points, inplace.
+    */
+    {
+        std::vector<__Tp> re(n), im(n);
+
+        for (size_t i = 0; i < n; ++i)
+            re[i] = Data[i].real(), im[i] = Data[i].imag();
+
+        forward(re.data(), im.data());
+
+        for (size_t i = 0; i < n; ++i) Data[i] = complex<__Tp>(re[i], im[i]);
+    }
+
+    void inverse(complex<__Tp>* Data, bool scale = true) const
+    /*
+    IDFT of n complex points, inplace.
+    */
+    {
+        std::vector<__Tp> re(n), im(n);
+
+        for (size_t i = 0; i < n; ++i)
+            re[i] = Data[i].real(), im[i] = Data[i].imag();
+
+        inverse(re.data(), im.data(), scale);
+
+        for (size_t i = 0; i < n; ++i) Data[i] = complex<__Tp>(re[i], im[i]);
+    }
+
+    static const plan& get(size_t N)
+    /*
+    Return the cached plan of size N, building it on first use.
+    */
+    {
+        static std::mutex lock;
+        static std::map<size_t, std::unique_ptr<plan> > cache;
+        std::lock_guard<std::mutex> guard(lock);
+        std::unique_ptr<plan>& p = cache[N];
+
+        if (!p) p.reset(new plan(N));
+
+        return *p;
+    }
+};
 
 template <typename __Tp>
-static void __FFT_Scale(const complex<__Tp>* Data, const unsigned int N) {
-    const auto fac = static_cast<__Tp>(1.0 / (N * 1.0));
+class real_plan {
+   private:
+    size_t n, h;
+    const plan<__Tp>& half;
+    std::vector<__Tp> wr, wi;
+
+    real_plan(const real_plan&) = delete;
+    real_plan& operator=(const real_plan&) = delete;
+
+   public:
+    explicit real_plan(size_t N) : n(N), h(N >> 1), half(plan<__Tp>::get(h))
+    /*
+    N has to be a power of 2 and at least 2.
+    */
+    {
+        const long double Pi = acosl(-1.0L);
+
+        for (size_t k = 0; k < h; ++k) {
+            wr.push_back(static_cast<__Tp>(cosl(-2 * Pi * k / n)));
+            wi.push_back(static_cast<__Tp>(sinl(-2 * Pi * k / n)));
+        }
+    }
+
+    size_t size() const { return n; }
 
-    for (unsigned int i = 0; i < N; ++i) Data[i] *= fac;
+    void forward(const __Tp* in, __Tp* re, __Tp* im) const
+    /*
+    DFT of n real points.
+    Writes the n / 2 + 1 non-redundant bins to re and im.
+    */
+    {
+        std::vector<__Tp> zr(h), zi(h);
+
+        for (size_t k = 0; k < h; ++k)
+            zr[k] = in[k << 1], zi[k] = in[k << 1 | 1];
+
+        half.forward(zr.data(), zi.data());
+        re[0] = zr[0] + zi[0], im[0] = 0;
+        re[h] = zr[0] - zi[0], im[h] = 0;
+
+        for (size_t k = 1; k < h; ++k) {
+            // Split Z into the transforms of the even and odd samples.
+            const __Tp er = (zr[k] + zr[h - k]) / 2;
+            const __Tp ei = (zi[k] - zi[h - k]) / 2;
+            const __Tp odr = (zi[k] + zi[h - k]) / 2;
+            const __Tp odi = (zr[h - k] - zr[k]) / 2;
+            re[k] = er + wr[k] * odr - wi[k] * odi;
+            im[k] = ei + wr[k] * odi + wi[k] * odr;
+        }
+    }
+
+    void inverse(const __Tp* re, const __Tp* im, __Tp* out,
+                 bool scale = true) const
+    /*
+    IDFT of the n / 2 + 1 bins produced by forward() back to n real points.
+    */
+    {
+        std::vector<__Tp> zr(h), zi(h);
+
+        for (size_t k = 0; k < h; ++k) {
+            const __Tp er = (re[k] + re[h - k]) / 2;
+            const __Tp ei = (im[k] - im[h - k]) / 2;
+            const __Tp dr = (re[k] - re[h - k]) / 2;
+            const __Tp di = (im[k] + im[h - k]) / 2;
+            const __Tp odr = dr * wr[k] + di * wi[k];
+            const __Tp odi = di * wr[k] - dr * wi[k];
+            zr[k] = er - odi, zi[k] = ei + odr;
+        }
+
+        half.inverse(zr.data(), zi.data(), scale);
+        const __Tp fac = scale ? static_cast<__Tp>(1) : static_cast<__Tp>(2);
+
+        for (size_t k = 0; k < h; ++k)
+            out[k << 1] = zr[k] * fac, out[k << 1 | 1] = zi[k] * fac;
+    }
+
+    static const real_plan& get(size_t N)
+    /*
+    Return the cached real plan of size N, building it on first use.
+    */
+    {
+        static std::mutex lock;
+        static std::map<size_t, std::unique_ptr<real_plan> > cache;
+        std::lock_guard<std::mutex> guard(lock);
+        std::unique_ptr<real_plan>& p = cache[N];
+
+        if (!p) p.reset(new real_plan(N));
+
+        return *p;
+    }
+};
+
+}  // namespace FFT
+
+namespace detail {
+template <typename __Tp>
+void __FFT_Axis(__Tp* re, __Tp* im, size_t outer, size_t len, size_t inner,
+                bool inv, unsigned threads) {
+    const size_t B = 16, blocks = (inner + B - 1) / B, jobs = outer * blocks;
+    const FFT::plan<__Tp>& p = FFT::plan<__Tp>::get(len);
+
+    auto work = [&](size_t lo, size_t hi) {
+        std::vector<__Tp> br(B * len), bi(B * len);
+
+        for (size_t job = lo; job < hi; ++job) {
+            size_t o = job / blocks, i0 = job % blocks * B;
+            size_t w = std::min(B, inner - i0);
+            __Tp *r = re + o * len * inner + i0, *m = im + o * len * inner + i0;
+
+            if (inner == 1) {
+                inv ? p.inverse(r, m, false) : p.forward(r, m);
+                continue;
+            }
+
+            // Gather w neighbouring columns so each line read is reused.
+            for (size_t k = 0; k < len; ++k)
+                for (size_t c = 0; c < w; ++c)
+                    br[c * len + k] = r[k * inner + c],
+                    bi[c * len + k] = m[k * inner + c];
+
+            for (size_t c = 0; c < w; ++c)
+                inv ? p.inverse(&br[c * len], &bi[c * len], false)
+                    : p.forward(&br[c * len], &bi[c * len]);
+
+            for (size_t k = 0; k < len; ++k)
+                for (size_t c = 0; c < w; ++c)
+                    r[k * inner + c] = br[c * len + k],
+                    m[k * inner + c] = bi[c * len + k];
+        }
+    };
+
+    threads = std::max(1u, std::min<unsigned>(threads, jobs));
+
+    if (threads == 1) return work(0, jobs);
+
+    std::vector<std::thread> pool;
+
+    for (unsigned t = 0; t < threads; ++t)
+        pool.emplace_back(work, jobs * t / threads, jobs * (t + 1) / threads);
+
+    for (auto& t : pool) t.join();
 }
 }  // namespace detail
 
 namespace FFT {
 template <typename __Tp>
-static bool DFT(const complex<__Tp>* const Input, const complex<__Tp>* Output,
+static bool DFT(const complex<__Tp>* const Input, complex<__Tp>* Output,
                 const unsigned int N)
 /*
 DFT Fourier Transform.
@@ -91,13 +418,13 @@ DFT Fourier Transform.
 {
     if (!Input || !Output || N < 1 || N & (N - 1)) return false;
 
-    detail::__FFT_Rearrange(Input, Output, N);
-    detail::__FFT_Perform(Output, N, false);
+    std::copy(Input, Input + N, Output);
+    plan<__Tp>::get(N).forward(Output);
     return true;
 }
 
 template <typename __Tp>
-static bool DFT(const complex<__Tp>* Data, const unsigned int N)
+static bool DFT(complex<__Tp>* Data, const unsigned int N)
 /*
 DFT Fourier Transform,
 inplace version.
@@ -105,13 +432,12 @@ inplace version.
 {
     if (!Data || N < 1 || N & (N - 1)) return false;
 
-    Rearange(Data, N);
-    detail::__FFT_Perform(Data, N, false);
+    plan<__Tp>::get(N).forward(Data);
     return true;
 }
 
 template <typename __Tp>
-static bool IDFT(const complex<__Tp>* const Input, const complex<__Tp>* Output,
+static bool IDFT(const complex<__Tp>* const Input, complex<__Tp>* Output,
                  const unsigned int N, const bool scale = true)
 /*
 IDFT Foureir Transform.
@@ -119,16 +445,13 @@ IDFT Foureir Transform.
 {
     if (!Input || !Output || N < 1 || N & (N - 1)) return false;
 
-    detail::__FFT_Rearrange(Input, Output, N);
-    detail::__FFT_Perform(Output, N, true);
-
-    if (scale) detail::__FFT_Scale(Output, N);
-
+    std::copy(Input, Input + N, Output);
+    plan<__Tp>::get(N).inverse(Output, scale);
     return true;
 }
 
 template <typename __Tp>
-static bool IDFT(const complex<__Tp>* Data, const unsigned int N,
+static bool IDFT(complex<__Tp>* Data, const unsigned int N,
                  const bool scale = true)
 /*
 IDFT Fourier Transform,
@@ -137,13 +460,82 @@ inplace version.
 {
     if (!Data || N < 1 || N & (N - 1)) return false;
 
-    detail::__FFT_Rearrange(Data, N);
-    detail::__FFT_Perform(Data, N, true);
+    plan<__Tp>::get(N).inverse(Data, scale);
+    return true;
+}
+template <typename __Tp>
+static bool DFT_nd(__Tp* re, __Tp* im, const std::vector<size_t>& dims,
+                   bool inv = false, unsigned threads = 1)
+/*
+Multidimensional DFT (IDFT when inv is set, scaled by 1 / total size)
+of a row-major array stored as separate real and imaginary parts.
+Every dimension has to be a power of 2.
+Lines along each axis are split between the given number of threads.
+*/
+{
+    size_t total = 1;
+
+    for (size_t d : dims) {
+        if (d < 1 || d & (d - 1)) return false;
+
+        total *= d;
+    }
+
+    if (!re || !im || dims.empty()) return false;
+
+    for (size_t a = 0, outer = 1; a < dims.size(); outer *= dims[a++])
+        if (dims[a] > 1)
+            detail::__FFT_Axis(re, im, outer, dims[a],
+                               total / outer / dims[a], inv, threads);
 
-    if (scale) detail::__FFT_Scale(Data, N);
+    if (inv) {
+        const __Tp fac = static_cast<__Tp>(1.0 / total);
+
+        for (size_t i = 0; i < total; ++i) re[i] *= fac, im[i] *= fac;
+    }
 
     return true;
 }
+
+template <typename __Tp>
+static bool DFT2(__Tp* re, __Tp* im, size_t rows, size_t cols,
+                 unsigned threads = 1)
+/*
+2-D DFT of a rows x cols row-major array.
+*/
+{
+    return DFT_nd(re, im, {rows, cols}, false, threads);
+}
+
+template <typename __Tp>
+static bool IDFT2(__Tp* re, __Tp* im, size_t rows, size_t cols,
+                  unsigned threads = 1)
+/*
+2-D IDFT of a rows x cols row-major array.
+*/
+{
+    return DFT_nd(re, im, {rows, cols}, true, threads);
+}
+
+template <typename __Tp>
+static bool DFT3(__Tp* re, __Tp* im, size_t d0, size_t d1, size_t d2,
+                 unsigned threads = 1)
+/*
+3-D DFT of a d0 x d1 x d2 row-major array.
+*/
+{
+    return DFT_nd(re, im, {d0, d1, d2}, false, threads);
+}
+
+template <typename __Tp>
+static bool IDFT3(__Tp* re, __Tp* im, size_t d0, size_t d1, size_t d2,
+                  unsigned threads = 1)
+/*
+3-D IDFT of a d0 x d1 x d2 row-major array.
+*/
+{
+    return DFT_nd(re, im, {d0, d1, d2}, true, threads);
+}
 }  // namespace FFT
 }  // namespace Octinc
 
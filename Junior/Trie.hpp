@@ -12,6 +12,8 @@
 #error "should use C++11 implementation"
 #endif
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -33,13 +35,13 @@ class Trie {
     };
 
     void clear(Node*) const;
-    void insert(std::string, Node*&, int);
-    void remove(std::string, Node*&, int);
+    void insert(const std::string&, Node*&, int);
+    void remove(const std::string&, Node*&, int);
 
-    Node* find(std::string, Node*, int) const;
-    int search(std::string, Node*, int, int) const;
-    void collect(std::string, Node*, std::vector<std::string>&) const;
-    void collect(std::string, std::string, Node*,
+    Node* find(const std::string&, Node*, int) const;
+    int search(const std::string&, Node*, int, int) const;
+    void collect(const std::string&, Node*, std::vector<std::string>&) const;
+    void collect(const std::string&, const std::string&, Node*,
                  std::vector<std::string>&) const;
 
     Node* _root;
@@ -52,29 +54,29 @@ class Trie {
     /*
     Get all the string in the tree.
     */
-    void insert(std::string);
+    void insert(const std::string&);
     /*
     Inset a string into the tree.
     */
-    void remove(std::string);
+    void remove(const std::string&);
     /*
     Remove the string from the tree.
     */
     void clear();
     bool empty();
-    bool find(std::string) const;
+    bool find(const std::string&) const;
     /*
     Determine whether the string exists in the tree.
     */
-    std::string longest_prefix(std::string) const;
+    std::string longest_prefix(const std::string&) const;
     /*
     Query the longest prefix of the specified string in the tree.
     */
-    std::vector<std::string> prefix(std::string) const;
+    std::vector<std::string> prefix(const std::string&) const;
     /*
     Query all the prefix of the specified string in the tree.
     */
-    std::vector<std::string> match(std::string) const;
+    std::vector<std::string> match(const std::string&) const;
     /*
     Query all the matched string in the tree.
     */
@@ -114,12 +116,12 @@ std::vector<std::string> Trie<CHARSET>::keys() {
 }
 
 template <const size_t CHARSET>
-void Trie<CHARSET>::insert(std::string key) {
+void Trie<CHARSET>::insert(const std::string& key) {
     insert(key, _root, 0);
 }
 
 template <const size_t CHARSET>
-void Trie<CHARSET>::insert(std::string key, Node*& ptr, int d) {
+void Trie<CHARSET>::insert(const std::string& key, Node*& ptr, int d) {
     if (ptr == nullptr) {
         ptr = new Node();
         ptr->col = Black;
@@ -137,12 +139,12 @@ void Trie<CHARSET>::insert(std::string key, Node*& ptr, int d) {
 }
 
 template <const size_t CHARSET>
-void Trie<CHARSET>::remove(std::string key) {
+void Trie<CHARSET>::remove(const std::string& key) {
     remove(key, _root, 0);
 }
 
 template <const size_t CHARSET>
-void Trie<CHARSET>::remove(std::string key, Node*& ptr, int d) {
+void Trie<CHARSET>::remove(const std::string& key, Node*& ptr, int d) {
     if (ptr == nullptr) return;
 
     if (d == key.size())
@@ -170,7 +172,7 @@ bool Trie<CHARSET>::empty() {
 }
 
 template <const size_t CHARSET>
-bool Trie<CHARSET>::find(std::string key) const {
+bool Trie<CHARSET>::find(const std::string& key) const {
     Node* p = find(key, _root, 0);
 
     if (p == nullptr) return false;
@@ -182,8 +184,8 @@ bool Trie<CHARSET>::find(std::string key) const {
 }
 
 template <const size_t CHARSET>
-typename Trie<CHARSET>::Node* Trie<CHARSET>::find(std::string key, Node* ptr,
-                                                  int d) const {
+typename Trie<CHARSET>::Node* Trie<CHARSET>::find(const std::string& key,
+                                                  Node* ptr, int d) const {
     if (ptr == nullptr) return nullptr;
 
     if (d == key.size()) return ptr;
@@ -194,7 +196,8 @@ typename Trie<CHARSET>::Node* Trie<CHARSET>::find(std::string key, Node* ptr,
 }
 
 template <const size_t CHARSET>
-int Trie<CHARSET>::search(std::string key, Node* ptr, int d, int len) const {
+int Trie<CHARSET>::search(const std::string& key, Node* ptr, int d,
+                          int len) const {
     if (ptr == nullptr) return len;
 
     if (ptr->col == Red) len = d;
@@ -207,13 +210,13 @@ int Trie<CHARSET>::search(std::string key, Node* ptr, int d, int len) const {
 }
 
 template <const size_t CHARSET>
-std::string Trie<CHARSET>::longest_prefix(std::string key) const {
+std::string Trie<CHARSET>::longest_prefix(const std::string& key) const {
     int len = search(key, _root, 0, 0);
     return key.substr(0, len);
 }
 
 template <const size_t CHARSET>
-void Trie<CHARSET>::collect(std::string key, Node* ptr,
+void Trie<CHARSET>::collect(const std::string& key, Node* ptr,
                             std::vector<std::string>& v) const {
     if (ptr == nullptr) return;
 
@@ -223,15 +226,15 @@ void Trie<CHARSET>::collect(std::string key, Node* ptr,
 }
 
 template <const size_t CHARSET>
-std::vector<std::string> Trie<CHARSET>::prefix(std::string key) const {
+std::vector<std::string> Trie<CHARSET>::prefix(const std::string& key) const {
     std::vector<std::string> v;
     collect(key, find(key, _root, 0), v);
     return v;
 }
 
 template <const size_t CHARSET>
-void Trie<CHARSET>::collect(std::string pre, std::string pat, Node* ptr,
-                            std::vector<std::string>& v) const {
+void Trie<CHARSET>::collect(const std::string& pre, const std::string& pat,
+                            Node* ptr, std::vector<std::string>& v) const {
     if (ptr == nullptr) return;
 
     int d = pre.size();
@@ -247,11 +250,242 @@ void Trie<CHARSET>::collect(std::string pre, std::string pat, Node* ptr,
 }
 
 template <const size_t CHARSET>
-std::vector<std::string> Trie<CHARSET>::match(std::string pat) const {
+std::vector<std::string> Trie<CHARSET>::match(const std::string& pat) const {
     std::vector<std::string> v;
     collect("", pat, _root, v);
     return v;
 }
+
+class radix_trie
+/*
+Static compressed radix tree over byte strings, built once from sorted
+keys. Nodes are laid out breadth first in one array, so the children of a
+node are adjacent and both a node's label in the shared pool and its
+children end where the next node's begin: a node takes 12 bytes plus one
+branch byte. Lookups are loops rather than recursions. Key ids are the
+ranks in sorted order.
+*/
+{
+   private:
+    struct Node {
+        unsigned int label;
+        unsigned int child;
+        int value;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<unsigned char> branch;
+    std::string pool;
+    size_t keys;
+
+    size_t length(const Node& u) const { return (&u + 1)->label - u.label; }
+    size_t count(const Node& u) const { return (&u + 1)->child - u.child; }
+    int child(const Node&, unsigned char) const;
+    const Node* walk(const char*, size_t, size_t&) const;
+
+   public:
+    radix_trie() : keys(0) { build(std::vector<std::string>()); }
+    explicit radix_trie(const std::vector<std::string>& sorted) {
+        build(sorted);
+    }
+
+    void build(const std::vector<std::string>&);
+    /*
+    Build from keys in ascending order, duplicates are kept once.
+    */
+    size_t size() const { return keys; }
+    size_t bytes() const;
+    /*
+    Memory taken by the tree.
+    */
+    int find(const char*, size_t) const;
+    int find(const std::string& key) const {
+        return find(key.data(), key.size());
+    }
+    /*
+    Id of the key, or -1 when absent.
+    */
+    size_t longest_prefix(const char*, size_t) const;
+    /*
+    Length of the longest key that is a prefix of the string, or 0.
+    */
+    template <typename _Func>
+    size_t prefixes_of(const char*, size_t, _Func) const;
+    /*
+    Call f(length, id) for every key that is a prefix of the string,
+    shortest first; returns how many.
+    */
+    template <typename _Func>
+    size_t with_prefix(const char*, size_t, _Func) const;
+    /*
+    Call f(key, length, id) for every key starting with the prefix, in
+    sorted order. key points into a buffer reused between calls.
+    */
+};
+
+inline void radix_trie::build(const std::vector<std::string>& sorted) {
+    struct Task {
+        unsigned int node;
+        size_t lo, hi, depth;
+    };
+
+    std::vector<size_t> id(sorted.size());
+    std::vector<Task> queue;
+
+    nodes.assign(1, Node()), branch.assign(1, 0), pool.clear(), keys = 0;
+    nodes[0].child = 1, nodes[0].value = -1;
+
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        if (i && sorted[i] == sorted[i - 1]) continue;
+        id[keys++] = i;
+    }
+
+    if (keys) queue.push_back(Task{0, 0, keys, 0});
+
+    // Breadth first, so the children of a node get adjacent slots.
+    for (size_t h = 0; h < queue.size(); ++h) {
+        Task t = queue[h];
+        const std::string &first = sorted[id[t.lo]],
+                          &last = sorted[id[t.hi - 1]];
+        size_t l = t.depth, end = std::min(first.size(), last.size());
+
+        while (l < end && first[l] == last[l]) ++l;
+
+        Node& u = nodes[t.node];
+        u.label = pool.size(), u.value = -1;
+        pool.append(first, t.depth, l - t.depth);
+
+        if (first.size() == l) u.value = t.lo++;
+
+        u.child = nodes.size();
+
+        for (size_t i = t.lo; i < t.hi;) {
+            size_t j = i;
+            unsigned char c = sorted[id[i]][l];
+
+            while (j < t.hi && (unsigned char)sorted[id[j]][l] == c) ++j;
+
+            queue.push_back(Task{(unsigned int)nodes.size(), i, j, l});
+            nodes.push_back(Node()), branch.push_back(c), i = j;
+        }
+    }
+
+    // Sentinel closing the last node's label and children.
+    Node end;
+    end.label = pool.size(), end.child = nodes.size(), end.value = -1;
+    nodes.push_back(end);
+    nodes.shrink_to_fit(), branch.shrink_to_fit(), pool.shrink_to_fit();
+}
+
+inline size_t radix_trie::bytes() const {
+    return nodes.capacity() * sizeof(Node) + branch.capacity() +
+           pool.capacity();
+}
+
+inline int radix_trie::child(const Node& u, unsigned char c) const {
+    const unsigned char* b = branch.data() + u.child;
+    const unsigned char *e = b + count(u), *p = std::lower_bound(b, e, c);
+    return p != e && *p == c ? u.child + (p - b) : -1;
+}
+
+inline const radix_trie::Node* radix_trie::walk(const char* key, size_t n,
+                                                size_t& d) const
+/*
+Follow the key as far as whole nodes match; d is the matched length.
+*/
+{
+    const Node* u = &nodes[0];
+    d = 0;
+
+    while (true) {
+        size_t l = length(*u);
+
+        if (n - d < l || memcmp(key + d, &pool[u->label], l)) return nullptr;
+
+        d += l;
+
+        if (d == n) return u;
+
+        int v = child(*u, key[d]);
+
+        if (v < 0) return nullptr;
+
+        u = &nodes[v];
+    }
+}
+
+inline int radix_trie::find(const char* key, size_t n) const {
+    size_t d;
+    const Node* u = walk(key, n, d);
+    return u ? u->value : -1;
+}
+
+inline size_t radix_trie::longest_prefix(const char* key, size_t n) const {
+    size_t best = 0;
+    prefixes_of(key, n, [&](size_t len, int) { best = len; });
+    return best;
+}
+
+template <typename _Func>
+size_t radix_trie::prefixes_of(const char* key, size_t n, _Func f) const {
+    const Node* u = &nodes[0];
+    size_t d = 0, cnt = 0;
+
+    for (size_t l; n - d >= (l = length(*u)) &&
+                   !memcmp(key + d, &pool[u->label], l);) {
+        d += l;
+
+        if (u->value >= 0) f(d, u->value), ++cnt;
+
+        int v = d < n ? child(*u, key[d]) : -1;
+
+        if (v < 0) break;
+
+        u = &nodes[v];
+    }
+
+    return cnt;
+}
+
+template <typename _Func>
+size_t radix_trie::with_prefix(const char* key, size_t n, _Func f) const {
+    unsigned int u = 0;
+    size_t d = 0;
+
+    // Descend to the node whose path first covers the prefix.
+    while (true) {
+        const Node& x = nodes[u];
+        size_t m = std::min(length(x), n - d);
+
+        if (memcmp(key + d, &pool[x.label], m)) return 0;
+
+        if (d + m == n) break;
+
+        int v = child(x, key[d += m]);
+
+        if (v < 0) return 0;
+
+        u = v;
+    }
+
+    std::string buf(key, d);
+    std::vector<std::pair<unsigned int, size_t> > stack(
+        1, std::make_pair(u, d));
+    size_t cnt = 0;
+
+    while (!stack.empty()) {
+        const Node& x = nodes[stack.back().first];
+        buf.resize(stack.back().second), stack.pop_back();
+        buf.append(&pool[x.label], length(x));
+
+        if (x.value >= 0) f(buf.data(), buf.size(), x.value), ++cnt;
+
+        for (unsigned int c = count(x); c--;)
+            stack.push_back(std::make_pair(x.child + c, buf.size()));
+    }
+
+    return cnt;
+}
 }  // namespace Octinc
 
 #endif
@@ -13,7 +13,10 @@
 #endif
 
 #include <algorithm>
+#include <cassert>
+#include <cstddef>
 #include <functional>
+#include <utility>
 #include <vector>
 
 namespace Octinc {
@@ -29,42 +32,63 @@ class heap {
 
     size_t parent(size_t node) const { return (node - 1) / 2; }
 
-    void adjustdown(size_t node) {
+    void adjustdown(size_t node)
+    /*
+    Sift down through a hole: children move up one step each, and the value
+    is written once at the end.
+    */
+    {
         __Cmp cmp;
         size_t siz = _data.size();
+        __Tp v = std::move(_data[node]);
 
         while (true) {
-            size_t l = left(node), r = right(node), nxt = node;
+            size_t l = left(node), r = right(node), nxt = l;
 
-            if (l < siz && cmp(_data[l], _data[node])) nxt = l;
-            if (r < siz && cmp(_data[r], _data[nxt])) nxt = r;
+            if (l >= siz) break;
+            if (r < siz && cmp(_data[r], _data[l])) nxt = r;
+            if (!cmp(_data[nxt], v)) break;
 
-            if (nxt != node) {
-                std::swap(_data[node], _data[nxt]);
-                node = nxt;
-            } else
-                break;
+            _data[node] = std::move(_data[nxt]);
+            node = nxt;
         }
+
+        _data[node] = std::move(v);
     }
 
     void adjustup(size_t node) {
         __Cmp cmp;
+        __Tp v = std::move(_data[node]);
 
         while (node > 0) {
             size_t p = parent(node);
 
-            if (cmp(_data[node], _data[p])) {
-                std::swap(_data[node], _data[p]);
-                node = p;
-            } else
-                break;
+            if (!cmp(v, _data[p])) break;
+
+            _data[node] = std::move(_data[p]);
+            node = p;
         }
+
+        _data[node] = std::move(v);
+    }
+
+    void heapify()
+    /*
+    Floyd's bottom-up construction, O(n).
+    */
+    {
+        for (size_t node = _data.size() / 2; node-- > 0;) adjustdown(node);
     }
 
    public:
     heap() {}
     heap(const heap& other) { *this = other; }
 
+    template <typename _It>
+    heap(_It first, _It last) : _data(first, last) {
+        heapify();
+    }
+
     __Tp pop()
     /*
     Delete and return the top of the heap.
@@ -72,20 +96,21 @@ class heap {
     {
         if (_data.empty()) return __Tp();
 
-        __Tp _top = _data[0];
+        __Tp _top = std::move(_data[0]);
         _data[0] = std::move(_data.back());
         _data.pop_back();
-        adjustdown(0);
+
+        if (!_data.empty()) adjustdown(0);
+
         return _top;
     }
 
     __Tp& top()
     /*
-    Return the top of the heap.
+    Return the top of the heap, which must not be empty.
     */
     {
-        if (_data.empty()) return *(_data.end());
-
+        assert(!_data.empty());
         return _data[0];
     }
 
@@ -94,10 +119,26 @@ class heap {
     Insert a value into heap.
     */
     {
-        _data.push_back(v);
+        _data.push_back(std::move(v));
         adjustup(_data.size() - 1);
     }
 
+    template <typename _It>
+    void push(_It first, _It last)
+    /*
+    Insert a batch of values, rebuilding in O(n) when that beats k pushes.
+    */
+    {
+        size_t old = _data.size();
+        _data.insert(_data.end(), first, last);
+
+        if (_data.size() - old > old / 4)
+            heapify();
+        else
+            for (size_t node = old; node < _data.size(); ++node)
+                adjustup(node);
+    }
+
     size_t size() const { return _data.size(); }
 
     bool empty() const { return _data.empty(); }
@@ -109,26 +150,218 @@ class heap {
     Remove all the elments in heap satisflying func.
     */
     {
-        if (_data.empty()) return;
+        auto it = std::remove_if(_data.begin(), _data.end(), func);
 
-        size_t fix_node = _data.size() - 1;
+        if (it == _data.end()) return;
+
+        _data.erase(it, _data.end());
+        heapify();
+    }
+};
+template <typename __Tp, typename __Cmp = std::less<__Tp>, size_t D = 4>
+class d_ary_heap
+/*
+A D-ary heap whose elements are addressed by handles, so a queued value can
+be changed (decrease-key or increase-key) or erased in O(log n). A handle
+stays valid until its element leaves the heap; after that it may be reused
+by a later push.
+With D = 4 or 8 the children of a node share one or two cache lines, and
+the tree is half or a third as deep as a binary one.
+*/
+{
+    static_assert(D >= 2, "HEAP:D should be at least 2.");
+
+   public:
+    typedef size_t handle;
+    static const handle npos = handle(-1);
+
+   private:
+    std::vector<__Tp> _data;
+    std::vector<handle> _handle;  // slot -> handle
+    std::vector<size_t> _pos;     // handle -> slot, or npos
+    std::vector<handle> _free;
+
+    void place(size_t node, __Tp&& v, handle h) {
+        _data[node] = std::move(v);
+        _handle[node] = h;
+        _pos[h] = node;
+    }
+
+    void sift_up(size_t node) {
+        __Cmp cmp;
+        __Tp v = std::move(_data[node]);
+        handle h = _handle[node];
+
+        while (node > 0) {
+            size_t p = (node - 1) / D;
+
+            if (!cmp(v, _data[p])) break;
+
+            place(node, std::move(_data[p]), _handle[p]);
+            node = p;
+        }
+
+        place(node, std::move(v), h);
+    }
+
+    void sift_down(size_t node) {
+        __Cmp cmp;
+        size_t siz = _data.size();
+        __Tp v = std::move(_data[node]);
+        handle h = _handle[node];
 
         while (true) {
-            auto it = std::find_if(_data.begin(), _data.end(), func);
-
-            if (it != _data.end()) {
-                _data.erase(it);
-                fix_node = std::min(fix_node,
-                                    (size_t)std::distance(_data.begin(), it));
-            } else
-                break;
+            size_t c = node * D + 1, best = c;
+
+            if (c >= siz) break;
+
+            for (size_t e = std::min(c + D, siz); ++c < e;)
+                if (cmp(_data[c], _data[best])) best = c;
+
+            if (!cmp(_data[best], v)) break;
+
+            place(node, std::move(_data[best]), _handle[best]);
+            node = best;
+        }
+
+        place(node, std::move(v), h);
+    }
+
+    void heapify() {
+        for (size_t node = (_data.size() + D - 2) / D; node-- > 0;)
+            sift_down(node);
+    }
+
+    void remove_slot(size_t node) {
+        _pos[_handle[node]] = npos;
+        _free.push_back(_handle[node]);
+
+        if (node + 1 == _data.size()) {
+            _data.pop_back(), _handle.pop_back();
+            return;
         }
 
-        size_t max_node = _data.size();
+        handle h = _handle.back();
+        place(node, std::move(_data.back()), h);
+        _data.pop_back(), _handle.pop_back();
+        sift_up(node);
+
+        if (_pos[h] == node) sift_down(node);
+    }
+
+   public:
+    d_ary_heap() {}
+
+    template <typename _It>
+    d_ary_heap(_It first, _It last)
+    /*
+    Heapify a range in O(n); the ith value gets handle i.
+    */
+        : _data(first, last) {
+        _handle.resize(_data.size());
+        _pos.resize(_data.size());
+
+        for (size_t i = 0; i < _data.size(); ++i) _handle[i] = _pos[i] = i;
 
-        for (size_t node = fix_node; node < max_node; ++node) adjustup(node);
+        heapify();
+    }
+
+    size_t size() const { return _data.size(); }
+
+    bool empty() const { return _data.empty(); }
+
+    void clear() {
+        _data.clear(), _handle.clear(), _pos.clear(), _free.clear();
+    }
+
+    handle push(__Tp v)
+    /*
+    Insert a value, returning its handle.
+    */
+    {
+        handle h;
+
+        if (!_free.empty())
+            h = _free.back(), _free.pop_back();
+        else
+            h = _pos.size(), _pos.push_back(npos);
+
+        _data.push_back(std::move(v));
+        _handle.push_back(h);
+        _pos[h] = _data.size() - 1;
+        sift_up(_data.size() - 1);
+        return h;
+    }
+
+    const __Tp& top() const
+    /*
+    Return the top of the heap, which must not be empty.
+    */
+    {
+        assert(!_data.empty());
+        return _data[0];
+    }
+
+    handle top_handle() const {
+        assert(!_data.empty());
+        return _handle[0];
+    }
+
+    __Tp pop()
+    /*
+    Delete and return the top of the heap.
+    */
+    {
+        if (_data.empty()) return __Tp();
+
+        __Tp _top = std::move(_data[0]);
+        remove_slot(0);
+        return _top;
+    }
+
+    bool contains(handle h) const {
+        return h < _pos.size() && _pos[h] != npos;
+    }
+
+    const __Tp& get(handle h) const
+    /*
+    The value of a queued handle.
+    */
+    {
+        assert(contains(h));
+        return _data[_pos[h]];
+    }
+
+    void update(handle h, __Tp v)
+    /*
+    Replace the value of a queued handle, moving it up or down.
+    */
+    {
+        assert(contains(h));
+        size_t node = _pos[h];
+        bool up = __Cmp()(v, _data[node]);
+
+        _data[node] = std::move(v);
+
+        if (up)
+            sift_up(node);
+        else
+            sift_down(node);
+    }
+
+    void erase(handle h)
+    /*
+    Remove a queued handle.
+    */
+    {
+        assert(contains(h));
+        remove_slot(_pos[h]);
     }
 };
+
+template <typename __Tp, typename __Cmp, size_t D>
+const typename d_ary_heap<__Tp, __Cmp, D>::handle
+    d_ary_heap<__Tp, __Cmp, D>::npos;
 }  // namespace Octinc
 
 #endif
@@ -0,0 +1,475 @@
+/* Octinc includes library.
+ *
+ * Copyright (C) 2019-2019 Octinc Repositories, WeKw team.
+ *
+ * The source uses the GNU AFFERO GENERAL PUBLIC LICENSE Version 3,
+ * please follow the licence.
+ */
+#ifndef OCTINC_INTEGER_SET__
+#define OCTINC_INTEGER_SET__
+
+#if __cplusplus < 201103L
+#error "should use C++11 implementation"
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace Octinc {
+template <typename __Tp>
+class integer_set
+/*
+An ordered set of integer keys kept in a 64-ary bitmap trie: each level
+consumes 6 bits of the key, so a 32-bit key is reached in 6 steps and a
+64-bit one in 11, each a popcount or a count of trailing zeros on one
+word, whatever the number of keys. Nodes store only their present
+children, packed by rank, so sparse key sets stay small.
+Iterators, lower_bound and upper_bound behave as in red_black_tree.
+*/
+{
+    static_assert(std::is_integral<__Tp>::value,
+                  "INTEGER_SET:key should be an integer type.");
+
+   private:
+    typedef uint64_t bits_type;
+
+    static const int Bits = sizeof(__Tp) * 8;
+    static const int Levels = (Bits + 5) / 6;
+
+    struct Node {
+        uint64_t mask;
+        uint32_t base, cap;
+        /*
+        The children of the set bits of mask are _slots[base, base + count),
+        in order; the arena block holds cap of them.
+        */
+    };
+
+    std::vector<Node> _nodes;
+    std::vector<uint64_t> _leaves;
+    std::vector<uint32_t> _slots;
+    std::vector<uint32_t> _free_nodes, _free_leaves, _free_slots[7];
+    size_t _size;
+
+    static bits_type to_bits(__Tp v) {
+        bits_type u = bits_type(typename std::make_unsigned<__Tp>::type(v));
+
+        if (std::is_signed<__Tp>::value) u ^= bits_type(1) << (Bits - 1);
+
+        return u;
+    }
+
+    static __Tp from_bits(bits_type u) {
+        if (std::is_signed<__Tp>::value) u ^= bits_type(1) << (Bits - 1);
+
+        return __Tp(typename std::make_unsigned<__Tp>::type(u));
+    }
+
+    static int shift(int d) { return 6 * (Levels - 1 - d); }
+
+    static int digit(bits_type u, int d) { return int(u >> shift(d)) & 63; }
+
+    static bits_type high(bits_type u, int d)
+    /*
+    The digits of u above level d.
+    */
+    {
+        return shift(d) + 6 >= 64 ? 0 : u >> (shift(d) + 6) << (shift(d) + 6);
+    }
+
+    static int count(uint64_t mask) { return __builtin_popcountll(mask); }
+
+    static int lowest(uint64_t mask) { return __builtin_ctzll(mask); }
+
+    static int highest(uint64_t mask) { return 63 - __builtin_clzll(mask); }
+
+    uint32_t& child(uint32_t n, int c) {
+        const Node& x = _nodes[n];
+        return _slots[x.base + count(x.mask & ((uint64_t(1) << c) - 1))];
+    }
+
+    uint32_t child(uint32_t n, int c) const {
+        const Node& x = _nodes[n];
+        return _slots[x.base + count(x.mask & ((uint64_t(1) << c) - 1))];
+    }
+
+    uint32_t alloc_slots(int k) {
+        if (!_free_slots[k].empty()) {
+            uint32_t base = _free_slots[k].back();
+            _free_slots[k].pop_back();
+            return base;
+        }
+
+        uint32_t base = uint32_t(_slots.size());
+        _slots.resize(_slots.size() + (size_t(1) << k));
+        return base;
+    }
+
+    void free_slots(uint32_t base, uint32_t cap) {
+        if (cap) _free_slots[lowest(cap)].push_back(base);
+    }
+
+    uint32_t new_node() {
+        Node x = {0, 0, 0};
+
+        if (!_free_nodes.empty()) {
+            uint32_t n = _free_nodes.back();
+            _free_nodes.pop_back();
+            _nodes[n] = x;
+            return n;
+        }
+
+        _nodes.push_back(x);
+        return uint32_t(_nodes.size() - 1);
+    }
+
+    uint32_t new_leaf() {
+        if (!_free_leaves.empty()) {
+            uint32_t n = _free_leaves.back();
+            _free_leaves.pop_back();
+            _leaves[n] = 0;
+            return n;
+        }
+
+        _leaves.push_back(0);
+        return uint32_t(_leaves.size() - 1);
+    }
+
+    void add_child(uint32_t n, int c, uint32_t ch) {
+        uint32_t cnt = count(_nodes[n].mask);
+        uint32_t r = count(_nodes[n].mask & ((uint64_t(1) << c) - 1));
+
+        if (cnt == _nodes[n].cap) {
+            uint32_t cap = cnt ? cnt * 2 : 1;
+            uint32_t base = alloc_slots(lowest(cap));
+
+            for (uint32_t i = 0; i < cnt; ++i)
+                _slots[base + i] = _slots[_nodes[n].base + i];
+
+            free_slots(_nodes[n].base, _nodes[n].cap);
+            _nodes[n].base = base, _nodes[n].cap = cap;
+        }
+
+        uint32_t* s = &_slots[_nodes[n].base];
+
+        for (uint32_t i = cnt; i > r; --i) s[i] = s[i - 1];
+
+        s[r] = ch;
+        _nodes[n].mask |= uint64_t(1) << c;
+    }
+
+    void remove_child(uint32_t n, int c) {
+        uint32_t cnt = count(_nodes[n].mask);
+        uint32_t r = count(_nodes[n].mask & ((uint64_t(1) << c) - 1));
+        uint32_t* s = &_slots[_nodes[n].base];
+
+        for (uint32_t i = r; i + 1 < cnt; ++i) s[i] = s[i + 1];
+
+        _nodes[n].mask &= ~(uint64_t(1) << c);
+    }
+
+    bool ceil(bits_type u, bits_type& res) const
+    /*
+    The smallest key not less than u.
+    */
+    {
+        uint32_t path[Levels];
+        uint32_t n = 0;
+        int d = 0;
+
+        for (; d < Levels - 1; ++d) {
+            path[d] = n;
+
+            if (!(_nodes[n].mask >> digit(u, d) & 1)) break;
+
+            n = child(n, digit(u, d));
+        }
+
+        if (d == Levels - 1) {
+            uint64_t m = _leaves[n] >> digit(u, d) << digit(u, d);
+
+            if (m) {
+                res = high(u, d) | bits_type(lowest(m));
+                return true;
+            }
+
+            --d;
+        }
+
+        for (; d >= 0; --d) {
+            int c = digit(u, d);
+            uint64_t m =
+                c == 63 ? 0 : _nodes[path[d]].mask >> (c + 1) << (c + 1);
+
+            if (!m) continue;
+
+            c = lowest(m);
+            res = high(u, d) | bits_type(c) << shift(d);
+            n = child(path[d], c);
+
+            for (++d; d < Levels - 1; ++d) {
+                c = lowest(_nodes[n].mask);
+                res |= bits_type(c) << shift(d);
+                n = child(n, c);
+            }
+
+            res |= bits_type(lowest(_leaves[n]));
+            return true;
+        }
+
+        return false;
+    }
+
+    bool floor(bits_type u, bits_type& res) const
+    /*
+    The largest key not greater than u.
+    */
+    {
+        uint32_t path[Levels];
+        uint32_t n = 0;
+        int d = 0;
+
+        for (; d < Levels - 1; ++d) {
+            path[d] = n;
+
+            if (!(_nodes[n].mask >> digit(u, d) & 1)) break;
+
+            n = child(n, digit(u, d));
+        }
+
+        if (d == Levels - 1) {
+            int c = digit(u, d);
+            uint64_t m = _leaves[n] & (c == 63 ? ~uint64_t(0)
+                                               : (uint64_t(2) << c) - 1);
+
+            if (m) {
+                res = high(u, d) | bits_type(highest(m));
+                return true;
+            }
+
+            --d;
+        }
+
+        for (; d >= 0; --d) {
+            int c = digit(u, d);
+            uint64_t m = _nodes[path[d]].mask & ((uint64_t(1) << c) - 1);
+
+            if (!m) continue;
+
+            c = highest(m);
+            res = high(u, d) | bits_type(c) << shift(d);
+            n = child(path[d], c);
+
+            for (++d; d < Levels - 1; ++d) {
+                c = highest(_nodes[n].mask);
+                res |= bits_type(c) << shift(d);
+                n = child(n, c);
+            }
+
+            res |= bits_type(highest(_leaves[n]));
+            return true;
+        }
+
+        return false;
+    }
+
+   public:
+    struct iterator : public std::iterator<std::input_iterator_tag, __Tp> {
+       private:
+        const integer_set* _set;
+        __Tp _key;
+        bool _valid;
+
+       public:
+        iterator(const integer_set* s = nullptr, __Tp k = __Tp(),
+                 bool valid = false)
+            : _set(s), _key(k), _valid(valid) {}
+
+        iterator operator++() {
+            if (_valid) *this = _set->upper_bound(_key);
+            return *this;
+        }
+        iterator operator--() {
+            if (_valid) *this = _set->lower_bound(_key);
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator _old = *this;
+            ++*this;
+            return _old;
+        }
+        iterator operator--(int) {
+            iterator _old = *this;
+            --*this;
+            return _old;
+        }
+
+        const __Tp operator*() const { return _valid ? _key : __Tp(); }
+
+        bool operator==(const iterator& other) const {
+            return _valid == other._valid && (!_valid || _key == other._key);
+        }
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    integer_set() { clear(); }
+
+    size_t size() const { return _size; }
+
+    bool empty() const { return _size == 0; }
+
+    void clear() {
+        _nodes.assign(1, Node{0, 0, 0});
+        _leaves.clear(), _slots.clear();
+        _free_nodes.clear(), _free_leaves.clear();
+
+        for (int k = 0; k < 7; ++k) _free_slots[k].clear();
+
+        _size = 0;
+    }
+
+    iterator insert(__Tp v)
+    /*
+    Insert a key.
+    */
+    {
+        bits_type u = to_bits(v);
+        uint32_t n = 0;
+
+        for (int d = 0; d < Levels - 1; ++d) {
+            int c = digit(u, d);
+
+            if (!(_nodes[n].mask >> c & 1))
+                add_child(n, c, d == Levels - 2 ? new_leaf() : new_node());
+
+            n = child(n, c);
+        }
+
+        uint64_t bit = uint64_t(1) << digit(u, Levels - 1);
+
+        if (!(_leaves[n] & bit)) _leaves[n] |= bit, ++_size;
+
+        return iterator(this, v, true);
+    }
+
+    bool remove(__Tp v)
+    /*
+    Delete the key; emptied nodes go back to the free lists.
+    */
+    {
+        bits_type u = to_bits(v);
+        uint32_t path[Levels], n = 0;
+
+        for (int d = 0; d < Levels - 1; ++d) {
+            path[d] = n;
+
+            if (!(_nodes[n].mask >> digit(u, d) & 1)) return false;
+
+            n = child(n, digit(u, d));
+        }
+
+        uint64_t bit = uint64_t(1) << digit(u, Levels - 1);
+
+        if (!(_leaves[n] & bit)) return false;
+
+        --_size;
+
+        if (_leaves[n] &= ~bit) return true;
+
+        _free_leaves.push_back(n);
+
+        for (int d = Levels - 2; d >= 0; --d) {
+            remove_child(path[d], digit(u, d));
+
+            if (_nodes[path[d]].mask || d == 0) break;
+
+            free_slots(_nodes[path[d]].base, _nodes[path[d]].cap);
+            _free_nodes.push_back(path[d]);
+        }
+
+        return true;
+    }
+
+    bool contains(__Tp v) const {
+        bits_type u = to_bits(v);
+        uint32_t n = 0;
+
+        for (int d = 0; d < Levels - 1; ++d) {
+            if (!(_nodes[n].mask >> digit(u, d) & 1)) return false;
+
+            n = child(n, digit(u, d));
+        }
+
+        return _leaves[n] >> digit(u, Levels - 1) & 1;
+    }
+
+    iterator find(__Tp v) const {
+        return contains(v) ? iterator(this, v, true) : end();
+    }
+
+    iterator begin() const {
+        bits_type r;
+        return ceil(0, r) ? iterator(this, from_bits(r), true) : end();
+    }
+
+    iterator end() const { return iterator(this); }
+
+    iterator minimum() const { return begin(); }
+
+    iterator maximum() const {
+        bits_type r;
+        return floor(Bits == 64 ? ~bits_type(0)
+                                : (bits_type(1) << Bits) - 1, r)
+                   ? iterator(this, from_bits(r), true)
+                   : end();
+    }
+
+    iterator lower_bound(__Tp v) const
+    /*
+    Query the largest number which is smaller than the key.
+    */
+    {
+        bits_type u = to_bits(v), r;
+        return u != 0 && floor(u - 1, r) ? iterator(this, from_bits(r), true)
+                                         : end();
+    }
+
+    iterator upper_bound(__Tp v) const
+    /*
+    Query the smallest number which is larger than the key.
+    */
+    {
+        bits_type u = to_bits(v), r;
+        bool last = Bits == 64 ? u == ~bits_type(0)
+                               : u == (bits_type(1) << Bits) - 1;
+        return !last && ceil(u + 1, r) ? iterator(this, from_bits(r), true)
+                                       : end();
+    }
+
+    iterator ceil(__Tp v) const
+    /*
+    Query the smallest number not less than the key.
+    */
+    {
+        bits_type r;
+        return ceil(to_bits(v), r) ? iterator(this, from_bits(r), true) : end();
+    }
+
+    iterator floor(__Tp v) const
+    /*
+    Query the largest number not greater than the key.
+    */
+    {
+        bits_type r;
+        return floor(to_bits(v), r) ? iterator(this, from_bits(r), true)
+                                    : end();
+    }
+};
+}  // namespace Octinc
+
+#endif
@@ -15,7 +15,9 @@
 #include <cassert>
 #include <climits>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
+#include <memory>
 #include <vector>
 
 namespace Octinc {
@@ -111,6 +113,80 @@ class memory_pool {
     }
 };
 
+template <typename __Tp, size_t block_size = 4096>
+class shared_pool
+/*
+A memory_pool that several containers can draw from, for node-based trees
+whose split and concat move nodes between containers. Copies share the
+pool; unite merges two pools union-find style, the root group owning all
+blocks and every member keeping its parent alive. So a node's memory lasts
+as long as any container that may still hold it. Not thread-safe.
+*/
+{
+   private:
+    struct group {
+        std::vector<std::unique_ptr<memory_pool<__Tp, block_size> > > pools;
+        std::shared_ptr<group> parent;
+    };
+
+    std::shared_ptr<group> _group;
+
+    memory_pool<__Tp, block_size>& root() {
+        while (_group->parent) _group = _group->parent;
+
+        return *_group->pools[0];
+    }
+
+   public:
+    typedef __Tp* pointer;
+
+    shared_pool() : _group(std::make_shared<group>()) {
+        _group->pools.emplace_back(new memory_pool<__Tp, block_size>());
+    }
+
+    pointer allocate() { return root().allocate(); }
+
+    void deallocate(pointer p) { root().deallocate(p); }
+
+    template <typename... Args>
+    pointer create(Args&&... args)
+    /*
+    Allocate and construct.
+    */
+    {
+        pointer p = allocate();
+        new (p) __Tp(std::forward<Args>(args)...);
+        return p;
+    }
+
+    void dispose(pointer p)
+    /*
+    Destroy and deallocate.
+    */
+    {
+        p->~__Tp();
+        deallocate(p);
+    }
+
+    void unite(shared_pool& other)
+    /*
+    Make both handles draw from one pool owning the blocks of both.
+    */
+    {
+        root(), other.root();
+
+        if (_group == other._group) return;
+
+        std::shared_ptr<group> g = other._group;
+
+        for (size_t i = 0; i < g->pools.size(); ++i)
+            _group->pools.push_back(std::move(g->pools[i]));
+
+        g->pools.clear();
+        g->parent = other._group = _group;
+    }
+};
+
 template <typename __Tp, const int block_size = 10000000>
 class memory_allocator : std::allocator<__Tp> {
    private:
@@ -8,7 +8,12 @@
 #ifndef OCTINC_PERSISTENCE_TREE__
 #define OCTINC_PERSISTENCE_TREE__
 
+#include <atomic>
 #include <cstdint>
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
 
 #if __cplusplus < 201103L
 #error "should use C++11 implementation"
@@ -147,6 +152,333 @@ class persistence_tree {
         left = right = 0;
     }
 };
+
+template <typename __Key, typename __Val, typename __Cmp = std::less<__Key> >
+class persistent_map
+/*
+An ordered map whose every copy is an independent version: copying (or
+snapshot()) is O(1), and updates copy only the O(log n) nodes on their
+path (a path-copying treap), sharing the rest with older versions.
+Nodes are reference counted atomically, so versions may live on different
+threads: a writer keeps updating its own map while readers query the
+snapshots it hands out. A single map object is not itself synchronised.
+*/
+{
+   private:
+    struct Node {
+        __Key key;
+        __Val val;
+        uint32_t pri;
+        size_t s;
+        Node *lc, *rc;
+        std::atomic<size_t> ref;
+
+        Node(const __Key& k, const __Val& v, uint32_t p)
+            : key(k), val(v), pri(p), s(1), lc(nullptr), rc(nullptr), ref(1) {}
+
+        Node(const Node& o)
+            : key(o.key),
+              val(o.val),
+              pri(o.pri),
+              s(o.s),
+              lc(acquire(o.lc)),
+              rc(acquire(o.rc)),
+              ref(1) {}
+
+        void maintain() { s = 1 + size(lc) + size(rc); }
+    };
+
+    Node* _root;
+
+    static size_t size(const Node* x) { return x ? x->s : 0; }
+
+    static uint32_t __priority() {
+        static thread_local std::mt19937 rnd(std::random_device{}());
+        return rnd();
+    }
+
+    static Node* acquire(Node* x) {
+        if (x) x->ref.fetch_add(1, std::memory_order_relaxed);
+        return x;
+    }
+
+    static void release(Node* x)
+    /*
+    Drop one reference; nodes reaching zero free their children in turn.
+    */
+    {
+        std::vector<Node*> stk;
+
+        for (stk.push_back(x); !stk.empty();) {
+            x = stk.back();
+            stk.pop_back();
+
+            if (!x || x->ref.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                continue;
+
+            stk.push_back(x->lc), stk.push_back(x->rc);
+            delete x;
+        }
+    }
+
+    static Node* __unshare(Node* x)
+    /*
+    Turn an owned reference into a node that may be written in place: a node
+    no other version can see is reused, a shared one is copied.
+    */
+    {
+        if (x->ref.load(std::memory_order_acquire) == 1) return x;
+
+        Node* y = new Node(*x);
+        release(x);
+        return y;
+    }
+
+    static Node* __rotate_right(Node* x) {
+        Node* y = x->lc;
+        x->lc = y->rc, y->rc = x;
+        x->maintain(), y->maintain();
+        return y;
+    }
+
+    static Node* __rotate_left(Node* x) {
+        Node* y = x->rc;
+        x->rc = y->lc, y->lc = x;
+        x->maintain(), y->maintain();
+        return y;
+    }
+
+    static Node* __insert(Node* x, const __Key& k, const __Val& v,
+                          bool& inserted) {
+        if (!x) {
+            inserted = true;
+            return new Node(k, v, __priority());
+        }
+
+        __Cmp cmp;
+        x = __unshare(x);
+
+        if (cmp(k, x->key)) {
+            x->lc = __insert(x->lc, k, v, inserted);
+            if (x->lc->pri > x->pri) x = __rotate_right(x);
+        } else if (cmp(x->key, k)) {
+            x->rc = __insert(x->rc, k, v, inserted);
+            if (x->rc->pri > x->pri) x = __rotate_left(x);
+        } else
+            x->val = v;
+
+        x->maintain();
+        return x;
+    }
+
+    static Node* __merge(Node* x, Node* y) {
+        if (!x) return y;
+        if (!y) return x;
+
+        if (x->pri > y->pri) {
+            x = __unshare(x);
+            x->rc = __merge(x->rc, y);
+            x->maintain();
+            return x;
+        } else {
+            y = __unshare(y);
+            y->lc = __merge(x, y->lc);
+            y->maintain();
+            return y;
+        }
+    }
+
+    static Node* __erase(Node* x, const __Key& k) {
+        __Cmp cmp;
+        x = __unshare(x);
+
+        if (cmp(k, x->key))
+            x->lc = __erase(x->lc, k);
+        else if (cmp(x->key, k))
+            x->rc = __erase(x->rc, k);
+        else {
+            Node* y = __merge(x->lc, x->rc);
+            x->lc = x->rc = nullptr;
+            release(x);
+            return y;
+        }
+
+        x->maintain();
+        return x;
+    }
+
+    const Node* __find(const __Key& k) const {
+        __Cmp cmp;
+        const Node* x = _root;
+
+        while (x && (cmp(k, x->key) || cmp(x->key, k)))
+            x = cmp(k, x->key) ? x->lc : x->rc;
+
+        return x;
+    }
+
+    template <typename _Func>
+    static void __range(const Node* x, const __Key& lo, const __Key& hi,
+                        _Func& f) {
+        __Cmp cmp;
+
+        while (x) {
+            if (cmp(x->key, lo))
+                x = x->rc;
+            else if (!cmp(x->key, hi))
+                x = x->lc;
+            else
+                break;
+        }
+
+        if (!x) return;
+
+        __range(x->lc, lo, hi, f);
+        f(x->key, x->val);
+        __range(x->rc, lo, hi, f);
+    }
+
+   public:
+    persistent_map() : _root(nullptr) {}
+
+    persistent_map(const persistent_map& other)
+        : _root(acquire(other._root)) {}
+
+    persistent_map(persistent_map&& other) : _root(other._root) {
+        other._root = nullptr;
+    }
+
+    persistent_map& operator=(const persistent_map& other) {
+        Node* x = acquire(other._root);
+        release(_root);
+        _root = x;
+        return *this;
+    }
+
+    persistent_map& operator=(persistent_map&& other) {
+        std::swap(_root, other._root);
+        return *this;
+    }
+
+    ~persistent_map() { release(_root); }
+
+    persistent_map snapshot() const
+    /*
+    The current version, in O(1). Later updates of either map are not seen
+    by the other.
+    */
+    {
+        return *this;
+    }
+
+    size_t size() const { return size(_root); }
+
+    bool empty() const { return _root == nullptr; }
+
+    bool insert(const __Key& k, const __Val& v)
+    /*
+    Insert a key, or assign its value if present. Returns whether the key
+    is new.
+    */
+    {
+        bool inserted = false;
+        _root = __insert(_root, k, v, inserted);
+        return inserted;
+    }
+
+    bool erase(const __Key& k)
+    /*
+    Remove a key. Returns whether it was present; an absent key copies
+    nothing.
+    */
+    {
+        if (!__find(k)) return false;
+
+        _root = __erase(_root, k);
+        return true;
+    }
+
+    const __Val* find(const __Key& k) const
+    /*
+    Pointer to the value of a key, or nullptr. It stays valid as long as
+    this version (or any copy of it) is alive and unmodified.
+    */
+    {
+        const Node* x = __find(k);
+        return x ? &x->val : nullptr;
+    }
+
+    bool contains(const __Key& k) const { return __find(k) != nullptr; }
+
+    std::pair<const __Key*, const __Val*> get_kth(size_t k) const
+    /*
+    The kth smallest key (1-based) and its value, or nullptrs.
+    */
+    {
+        const Node* x = _root;
+
+        while (x) {
+            if (k <= size(x->lc))
+                x = x->lc;
+            else if (k == size(x->lc) + 1)
+                return std::make_pair(&x->key, &x->val);
+            else
+                k -= size(x->lc) + 1, x = x->rc;
+        }
+
+        return std::make_pair(nullptr, nullptr);
+    }
+
+    size_t get_rank(const __Key& k) const
+    /*
+    The rank of k (1-based): one more than the number of keys smaller
+    than k, so get_kth(get_rank(k)) finds k when it is present.
+    */
+    {
+        __Cmp cmp;
+        size_t rank = 0;
+
+        for (const Node* x = _root; x;)
+            if (cmp(x->key, k))
+                rank += size(x->lc) + 1, x = x->rc;
+            else
+                x = x->lc;
+
+        return rank + 1;
+    }
+
+    template <typename _Func>
+    void range(const __Key& lo, const __Key& hi, _Func f) const
+    /*
+    Call f(key, value) for the keys in [lo, hi) in order.
+    */
+    {
+        __range(_root, lo, hi, f);
+    }
+
+    template <typename _Func>
+    void for_each(_Func f) const
+    /*
+    Call f(key, value) for every key in order.
+    */
+    {
+        std::vector<const Node*> stk;
+
+        for (const Node* x = _root; x || !stk.empty();) {
+            for (; x; x = x->lc) stk.push_back(x);
+
+            x = stk.back();
+            stk.pop_back();
+            f(x->key, x->val);
+            x = x->rc;
+        }
+    }
+
+    void clear() {
+        release(_root);
+        _root = nullptr;
+    }
+};
 }  // namespace Octinc
 
 #endif
@@ -0,0 +1,312 @@
+/* Octinc includes library.
+ *
+ * Copyright (C) 2019-2019 Octinc Repositories, WeKw team.
+ *
+ * The source uses the GNU AFFERO GENERAL PUBLIC LICENSE Version 3,
+ * please follow the licence.
+ */
+#ifndef OCTINC_RADIX_HEAP__
+#define OCTINC_RADIX_HEAP__
+
+#if __cplusplus < 201103L
+#error "should use C++11 implementation"
+#endif
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Octinc {
+template <typename __Key, typename __Tp = __Key>
+class radix_heap
+/*
+A min-heap for monotone integer keys: no key pushed may be smaller than the
+last key popped, as in Dijkstra's algorithm or a timer wheel. Bucket i holds
+the keys whose highest bit differing from the last popped key is bit i - 1,
+so a key moves to a lower bucket at most once per bit: push is O(1) and pop
+amortised O(log C) for keys at most C apart, over contiguous vectors.
+radix_heap<K> queues bare keys; radix_heap<K, T> carries a value with each.
+*/
+{
+    static_assert(std::is_integral<__Key>::value,
+                  "RADIX_HEAP:key should be an integer type.");
+
+   private:
+    typedef typename std::make_unsigned<__Key>::type bits_type;
+
+    static const int Bits = sizeof(__Key) * 8;
+
+    typedef std::pair<bits_type, __Tp> entry;
+
+    std::vector<entry> _buckets[Bits + 1];
+    bits_type _last;
+    size_t _size;
+    int _min_bucket;
+    size_t _min_index;
+    /*
+    Every bucket is relative to _last, the last popped key, which moves only
+    in pop. When bucket 0 is empty, the minimum is cached at
+    _buckets[_min_bucket][_min_index], or _min_bucket is 0 if unknown.
+    */
+
+    static bits_type to_bits(__Key k) {
+        bits_type u = bits_type(k);
+
+        if (std::is_signed<__Key>::value) u ^= bits_type(1) << (Bits - 1);
+
+        return u;
+    }
+
+    static __Key from_bits(bits_type u) {
+        if (std::is_signed<__Key>::value) u ^= bits_type(1) << (Bits - 1);
+
+        return __Key(u);
+    }
+
+    int bucket(bits_type u) const {
+        return u == _last ? 0 : 64 - __builtin_clzll(uint64_t(u ^ _last));
+    }
+
+    entry& minimum()
+    /*
+    Locate the entry of the smallest key without moving any.
+    */
+    {
+        if (!_buckets[0].empty()) return _buckets[0].back();
+
+        if (_min_bucket == 0) {
+            int i = 1;
+
+            while (_buckets[i].empty()) ++i;
+
+            _min_bucket = i, _min_index = 0;
+
+            for (size_t j = 1; j < _buckets[i].size(); ++j)
+                if (_buckets[i][j].first < _buckets[i][_min_index].first)
+                    _min_index = j;
+        }
+
+        return _buckets[_min_bucket][_min_index];
+    }
+
+    void pull()
+    /*
+    Refill bucket 0 from the bucket of the minimum, which becomes the new
+    last key.
+    */
+    {
+        if (!_buckets[0].empty()) return;
+
+        minimum();
+
+        std::vector<entry>& b = _buckets[_min_bucket];
+        _last = b[_min_index].first;
+        // Moved last, the entry top() returned stays the one pop() takes.
+        std::swap(b[_min_index], b.back());
+
+        for (size_t j = 0; j < b.size(); ++j)
+            _buckets[bucket(b[j].first)].push_back(std::move(b[j]));
+
+        b.clear();
+        _min_bucket = 0;
+    }
+
+   public:
+    radix_heap() : _last(0), _size(0), _min_bucket(0), _min_index(0) {}
+
+    size_t size() const { return _size; }
+
+    bool empty() const { return _size == 0; }
+
+    void clear() {
+        for (int i = 0; i <= Bits; ++i) _buckets[i].clear();
+
+        _last = 0, _size = 0, _min_bucket = 0;
+    }
+
+    void push(__Key k, __Tp v)
+    /*
+    Insert a value with key k, which must not be below the last popped key.
+    */
+    {
+        bits_type u = to_bits(k);
+        int i = bucket(u);
+
+        assert(u >= _last);
+        _buckets[i].push_back(std::make_pair(u, std::move(v)));
+        ++_size;
+
+        if (_min_bucket != 0 && u < _buckets[_min_bucket][_min_index].first)
+            _min_bucket = i, _min_index = _buckets[i].size() - 1;
+    }
+
+    void push(__Key k)
+    /*
+    Insert a bare key.
+    */
+    {
+        push(k, __Tp(k));
+    }
+
+    __Key top_key()
+    /*
+    Return the smallest key; the heap must not be empty.
+    */
+    {
+        assert(_size != 0);
+        return from_bits(minimum().first);
+    }
+
+    __Tp& top()
+    /*
+    Return the value of the smallest key; the heap must not be empty.
+    */
+    {
+        assert(_size != 0);
+        return minimum().second;
+    }
+
+    __Tp pop()
+    /*
+    Delete and return the value of the smallest key.
+    */
+    {
+        if (_size == 0) return __Tp();
+
+        pull();
+        __Tp _top = std::move(_buckets[0].back().second);
+        _buckets[0].pop_back();
+        --_size;
+        return _top;
+    }
+};
+
+template <typename __Key, typename __Tp = __Key>
+class bucket_queue
+/*
+Dial's bucket queue for monotone integer keys whose queued keys are never
+more than a fixed span C apart: a ring of C + 1 buckets (rounded up to a
+power of two) indexed by key, so push is O(1) and pop moves a cursor that
+sweeps each key value once, O(1) amortised per unit of key.
+Best when C is small, such as small integer edge weights or timer ticks.
+*/
+{
+    static_assert(std::is_integral<__Key>::value,
+                  "BUCKET_QUEUE:key should be an integer type.");
+
+   private:
+    std::vector<std::vector<std::pair<__Key, __Tp> > > _buckets;
+    size_t _mask, _size;
+    __Key _last, _cur, _max;
+    /*
+    _last is the last popped key; while the queue is not empty, _cur is its
+    smallest key and _max an upper bound on its keys.
+    */
+
+    void pull()
+    /*
+    Advance the cursor to the first non-empty bucket.
+    */
+    {
+        while (_buckets[size_t(_cur) & _mask].empty()) ++_cur;
+    }
+
+   public:
+    explicit bucket_queue(size_t span)
+    /*
+    span is the largest gap allowed between two queued keys.
+    */
+        : _size(0),
+          _last(std::numeric_limits<__Key>::min()),
+          _cur(0),
+          _max(0) {
+        size_t n = 1;
+
+        while (n <= span) n <<= 1;
+
+        _buckets.resize(n);
+        _mask = n - 1;
+    }
+
+    size_t size() const { return _size; }
+
+    bool empty() const { return _size == 0; }
+
+    void clear() {
+        for (size_t i = 0; i <= _mask; ++i) _buckets[i].clear();
+
+        _size = 0, _last = std::numeric_limits<__Key>::min();
+    }
+
+    void push(__Key k, __Tp v)
+    /*
+    Insert a value with key k, which must not be below the last popped key
+    nor leave the queued keys more than span apart.
+    */
+    {
+        assert(k >= _last);
+
+        if (_size == 0)
+            _cur = _max = k;
+        else if (k < _cur)
+            _cur = k;
+        else if (k > _max)
+            _max = k;
+
+        assert(size_t(_max) - size_t(_cur) <= _mask);
+
+        _buckets[size_t(k) & _mask].push_back(std::make_pair(k, std::move(v)));
+        ++_size;
+    }
+
+    void push(__Key k)
+    /*
+    Insert a bare key.
+    */
+    {
+        push(k, __Tp(k));
+    }
+
+    __Key top_key()
+    /*
+    Return the smallest key; the queue must not be empty.
+    */
+    {
+        assert(_size != 0);
+        return _cur;
+    }
+
+    __Tp& top()
+    /*
+    Return the value of the smallest key; the queue must not be empty.
+    */
+    {
+        assert(_size != 0);
+        return _buckets[size_t(_cur) & _mask].back().second;
+    }
+
+    __Tp pop()
+    /*
+    Delete and return the value of the smallest key.
+    */
+    {
+        if (_size == 0) return __Tp();
+
+        _last = _cur;
+        std::vector<std::pair<__Key, __Tp> >& b =
+            _buckets[size_t(_cur) & _mask];
+        __Tp _top = std::move(b.back().second);
+        b.pop_back();
+
+        if (--_size != 0) pull();
+
+        return _top;
+    }
+};
+}  // namespace Octinc
+
+#endif
@@ -18,12 +18,19 @@
 #include <utility>
 #include <vector>
 
+#include "tiered_vector.hpp"
+
 namespace Octinc {
 template <typename __Key, typename __Cmp = std::less<__Key>,
           typename __Alloc = std::allocator<__Key> >
 class raccess_set {
    private:
-    typedef std::vector<__Key, __Alloc> Vector;
+    typedef tiered_vector<__Key, __Alloc> Vector;
+    /*
+    Sorted storage in a tiered_vector: insert and erase are O(sqrt n)
+    instead of O(n), while indexing and iteration stay O(1). Like every
+    tiered_vector element, __Key has to be default-constructible.
+    */
 
    public:
     typedef __Key key_type;
@@ -91,7 +98,7 @@ class raccess_set {
     allocator_type get_allocator() const;
 
    private:
-    std::vector<__Key> vector_;
+    Vector vector_;
     __Cmp compare_;
 };
 
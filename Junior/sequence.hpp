@@ -16,6 +16,8 @@
 #include <cstring>
 #include <iostream>
 #include <set>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 namespace Octinc {
@@ -38,6 +40,331 @@ void __select_kth(__Tp* a, const int l, const int r, const int k) {
     if (l <= j && k <= j - l + 1) __select_kth(a, l, j, k);
     if (i <= r && k >= i - l + 1) __select_kth(a, i, r, k - (i - l));
 }
+
+struct __bit_masks
+/*
+Match masks of a sequence of symbol ids for the bit-parallel kernels, one bit
+per position and 64 per word. A symbol keeps only its non-zero words, so the
+masks take space linear in the sequence. col[j] is the local symbol of the
+j-th element of the other sequence, or -1 when it matches nothing.
+*/
+{
+    int n, words;
+    std::vector<int> begin, block, col;
+    std::vector<unsigned long long> bits;
+
+    void build(const int* a, int na, const int* b, int nb,
+               std::vector<int>& slot)
+    /*
+    slot must map every id to -1; it is left that way on return.
+    */
+    {
+        std::vector<int> used, last, top;
+
+        n = na, words = (na + 63) >> 6;
+        begin.assign(1, 0);
+
+        for (int i = 0; i < na; ++i) {
+            int& s = slot[a[i]];
+
+            if (s < 0) {
+                s = used.size(), used.push_back(a[i]);
+                last.push_back(-1), begin.push_back(0);
+            }
+
+            if (last[s] != (i >> 6)) last[s] = i >> 6, ++begin[s + 1];
+        }
+
+        for (size_t s = 0; s < used.size(); ++s) begin[s + 1] += begin[s];
+
+        block.resize(begin.back()), bits.assign(begin.back(), 0);
+        top.assign(begin.begin(), begin.end() - 1);
+        std::fill(last.begin(), last.end(), -1);
+
+        for (int i = 0; i < na; ++i) {
+            int s = slot[a[i]];
+
+            if (last[s] != (i >> 6)) last[s] = i >> 6, block[top[s]++] = i >> 6;
+
+            bits[top[s] - 1] |= 1ull << (i & 63);
+        }
+
+        col.resize(nb);
+
+        for (int j = 0; j < nb; ++j) col[j] = slot[b[j]];
+
+        for (size_t s = 0; s < used.size(); ++s) slot[used[s]] = -1;
+    }
+};
+
+inline void __lcs_columns(const __bit_masks& m,
+                          std::vector<unsigned long long>& V)
+/*
+Hyyro's bit-parallel LCS: after the last column, the zero bits of V in the
+first i rows count LCS(a[0, i), b). V' = (V + U) | (V - U) with U = V & Eq;
+as U lies inside V the subtraction never borrows, so only words with a match
+and the carries out of them are touched.
+*/
+{
+    V.assign(m.words, ~0ull);
+
+    for (size_t j = 0; j < m.col.size(); ++j) {
+        int s = m.col[j];
+
+        if (s < 0) continue;
+
+        unsigned long long carry = 0;
+        int w = 0;
+
+        for (int r = m.begin[s]; r < m.begin[s + 1]; ++r) {
+            int k = m.block[r];
+
+            for (; carry && w < k; ++w) {
+                unsigned long long x = V[w];
+                V[w] = (x + 1) | x, carry = (x == ~0ull);
+            }
+
+            unsigned long long x = V[k], u = x & m.bits[r];
+            unsigned long long sum = x + u, out = sum < x;
+            sum += carry, out |= sum < carry;
+            V[k] = sum | (x & ~u), carry = out, w = k + 1;
+        }
+
+        for (; carry && w < m.words; ++w) {
+            unsigned long long x = V[w];
+            V[w] = (x + 1) | x, carry = (x == ~0ull);
+        }
+    }
+}
+
+inline int __lcs_length(const __bit_masks& m, std::vector<int>* prefix = 0)
+/*
+LCS length of the two sequences; prefix, if given, gets LCS(a[0, i), b) for
+every i in [0, n].
+*/
+{
+    std::vector<unsigned long long> V;
+    int zeros = 0;
+
+    __lcs_columns(m, V);
+
+    if (prefix) prefix->assign(m.n + 1, 0);
+
+    for (int i = 0; i < m.n; i += 64) {
+        unsigned long long z = ~V[i >> 6];
+
+        if (m.n - i < 64) z &= (1ull << (m.n - i)) - 1;
+
+        if (prefix)
+            for (int k = 0; k < 64 && i + k < m.n; ++k)
+                (*prefix)[i + k + 1] = zeros + __builtin_popcountll(
+                                                   z & (~0ull >> (63 - k)));
+
+        zeros += __builtin_popcountll(z);
+    }
+
+    return zeros;
+}
+
+inline int __myers_block(unsigned long long& Pv, unsigned long long& Mv,
+                         unsigned long long Eq, int hin, int hb)
+/*
+One 64-row block of Myers' edit distance column step (Hyyro's formulation):
+hin is the horizontal delta entering above the block, the horizontal delta
+of row hb is returned.
+*/
+{
+    unsigned long long Xv = Eq | Mv;
+
+    if (hin < 0) Eq |= 1;
+
+    unsigned long long Xh = (((Eq & Pv) + Pv) ^ Pv) | Eq;
+    unsigned long long Ph = Mv | ~(Xh | Pv), Mh = Pv & Xh;
+    int hout = int(Ph >> hb & 1) - int(Mh >> hb & 1);
+
+    Ph <<= 1, Mh <<= 1;
+
+    if (hin < 0)
+        Mh |= 1;
+    else if (hin > 0)
+        Ph |= 1;
+
+    Pv = Mh | ~(Xv | Ph), Mv = Ph & Xv;
+
+    return hout;
+}
+
+inline int __myers_distance(const __bit_masks& m, int band = -1,
+                            std::vector<int>* column = 0)
+/*
+Levenshtein distance of the two sequences, 64 rows per word. With band >= 0
+only rows within band of the diagonal are kept alive (blocks join below as
+the band reaches them and leave above once it has passed), and -1 is
+returned when the distance exceeds band. column, unbanded only, gets the
+distance from a[0, i) to b for every i in [0, n].
+*/
+{
+    const int n1 = m.n, n2 = m.col.size(), W = m.words;
+
+    if (band >= 0 && std::abs(n1 - n2) > band) return -1;
+
+    if (n1 == 0) {
+        if (column) column->assign(1, n2);
+
+        return n2;
+    }
+
+    std::vector<unsigned long long> Pv(W, ~0ull), Mv(W, 0);
+    std::vector<int> score(W);
+    int first = 0, last = band < 0 ? W - 1 : std::min(W - 1, band >> 6);
+
+    for (int b = 0; b < W; ++b) score[b] = std::min(64 * (b + 1), n1);
+
+    for (int j = 1; j <= n2; ++j) {
+        int s = m.col[j - 1];
+
+        if (band >= 0) {
+            // Rows past j + band cannot be within band yet.
+            for (int to = std::min(W - 1, (j + band - 1) >> 6); last < to;) {
+                ++last;
+                Pv[last] = ~0ull, Mv[last] = 0;
+                score[last] = score[last - 1] + std::min(64, n1 - 64 * last);
+            }
+        }
+
+        const int* r = s < 0 ? 0 : &m.block[0] + m.begin[s];
+        const int* end = s < 0 ? 0 : &m.block[0] + m.begin[s + 1];
+        int hin = 1;
+
+        if (r && first) r = std::lower_bound(r, end, first);
+
+        for (int b = first; b <= last; ++b) {
+            unsigned long long Eq = 0;
+
+            if (r != end && *r == b) Eq = m.bits[r - &m.block[0]], ++r;
+
+            hin = __myers_block(Pv[b], Mv[b], Eq, hin,
+                                b == W - 1 ? (n1 - 1) & 63 : 63);
+            score[b] += hin;
+        }
+
+        if (band >= 0) {
+            // Blocks wholly above row j - band never come back into band.
+            while (first < last && 64 * (first + 1) < j - band) ++first;
+
+            if (last == W - 1 && score[last] - (n2 - j) > band) return -1;
+        }
+    }
+
+    if (column) {
+        column->assign(n1 + 1, n2);
+
+        for (int i = 0; i < n1; ++i)
+            (*column)[i + 1] = (*column)[i] + int(Pv[i >> 6] >> (i & 63) & 1) -
+                               int(Mv[i >> 6] >> (i & 63) & 1);
+    }
+
+    return band >= 0 && score[W - 1] > band ? -1 : score[W - 1];
+}
+
+inline int __align(const int* a, int na, const int* b, int nb, bool substitute,
+                   std::vector<int>& slot, std::string& ops)
+/*
+Hirschberg's divide and conquer over the bit-parallel kernels: b is split in
+half, the forward and reversed score columns pick the row the optimal path
+crosses at, and both halves recurse. Linear memory, about twice the time of
+the distance alone. Without substitute only insertions and deletions are
+allowed, i.e. an LCS diff.
+*/
+{
+    if (nb == 0 || na == 0) {
+        ops.append(na, 'D'), ops.append(nb, 'I');
+        return na + nb;
+    }
+
+    if (nb == 1 || na == 1) {
+        const int* p = nb == 1 ? std::find(a, a + na, b[0])
+                               : std::find(b, b + nb, a[0]);
+        int at = p - (nb == 1 ? a : b), len = nb == 1 ? na : nb;
+        char skip = nb == 1 ? 'D' : 'I';
+
+        if (at < len) {
+            ops.append(at, skip), ops += '=', ops.append(len - at - 1, skip);
+            return len - 1;
+        }
+
+        if (substitute) {
+            ops += 'X', ops.append(len - 1, skip);
+            return len;
+        }
+
+        ops.append(na, 'D'), ops.append(nb, 'I');
+        return na + nb;
+    }
+
+    const int mid = nb >> 1;
+    int cut = 0;
+
+    {
+        std::vector<int> F, R, ra(a, a + na), rb(b + mid, b + nb);
+        __bit_masks m;
+
+        std::reverse(ra.begin(), ra.end()), std::reverse(rb.begin(), rb.end());
+
+        m.build(a, na, b, mid, slot);
+
+        if (substitute)
+            __myers_distance(m, -1, &F);
+        else
+            __lcs_length(m, &F);
+
+        m.build(&ra[0], na, &rb[0], nb - mid, slot);
+
+        if (substitute)
+            __myers_distance(m, -1, &R);
+        else
+            __lcs_length(m, &R);
+
+        // Distances for substitute, LCS lengths (to maximise) otherwise.
+        long long best = 0;
+
+        for (int i = 0; i <= na; ++i) {
+            long long v = substitute ? -(long long)(F[i] + R[na - i])
+                                     : (long long)F[i] + R[na - i];
+
+            if (i == 0 || v > best) best = v, cut = i;
+        }
+    }
+
+    return __align(a, cut, b, mid, substitute, slot, ops) +
+           __align(a + cut, na - cut, b + mid, nb - mid, substitute, slot,
+                   ops);
+}
+
+template <typename __Tp>
+int __symbol_ids(const __Tp* A, int n1, const __Tp* B, int n2,
+                 std::vector<int>& a, std::vector<int>& b)
+/*
+Replace the elements by dense ids, those of B missing from A sharing one id;
+returns the number of ids.
+*/
+{
+    std::vector<typename std::remove_cv<__Tp>::type> sym(A, A + n1);
+
+    std::sort(sym.begin(), sym.end());
+    sym.erase(std::unique(sym.begin(), sym.end()), sym.end());
+    a.resize(n1), b.resize(n2);
+
+    for (int i = 0; i < n1; ++i)
+        a[i] = std::lower_bound(sym.begin(), sym.end(), A[i]) - sym.begin();
+
+    for (int j = 0; j < n2; ++j) {
+        int k = std::lower_bound(sym.begin(), sym.end(), B[j]) - sym.begin();
+        b[j] = k < (int)sym.size() && sym[k] == B[j] ? k : sym.size();
+    }
+
+    return sym.size() + 1;
+}
 }  // namespace detail
 namespace sequence {
 template <typename __Tp>
@@ -168,28 +495,52 @@ template <typename __Tp>
 int LCS(__Tp* A, int n1, __Tp* B, int n2)
 /*
 Find the length of the longest common subsequence of arrays a and b.
+Bit-parallel over a, O(n1 * n2 / 64) time and linear memory; elements
+need operator< and operator==.
 */
 {
-    int** f = new int*[2 * n1 + 1];
+    std::vector<int> a, b, slot;
+    detail::__bit_masks m;
+
+    slot.assign(detail::__symbol_ids(A, n1, B, n2, a, b), -1);
+    m.build(a.data(), n1, b.data(), n2, slot);
 
-    for (int i = 0; i <= 2 * n1; ++i)
-        f[i] = new int[2 * n2 + 1], memset(f[i], 0, (2 * n2 + 1) * sizeof(int));
+    return detail::__lcs_length(m);
+}
 
-    for (int i = 1; i <= n1; ++i)
-        for (int j = 1; j <= n2; ++j) {
-            f[i][j] = f[i - 1][j];
+template <typename __Tp>
+int edit_distance(__Tp* A, int n1, __Tp* B, int n2, int band = -1)
+/*
+Levenshtein distance of arrays a and b by Myers' bit-parallel algorithm.
+With band >= 0 only O(n2 * band / 64) work is done and -1 is returned if
+the distance is greater than band.
+*/
+{
+    std::vector<int> a, b, slot;
+    detail::__bit_masks m;
 
-            if (f[i][j - 1] > f[i][j]) f[i][j] = f[i][j - 1];
+    slot.assign(detail::__symbol_ids(A, n1, B, n2, a, b), -1);
+    m.build(a.data(), n1, b.data(), n2, slot);
 
-            if (A[i - 1] == B[j - 1] && f[i - 1][j - 1] + 1 > f[i][j])
-                f[i][j] = f[i - 1][j - 1] + 1;
-        }
+    return detail::__myers_distance(m, band);
+}
 
-    for (int i = 0; i <= 2 * n1; ++i) delete[] f[i];
+template <typename __Tp>
+int alignment(__Tp* A, int n1, __Tp* B, int n2, std::string& ops,
+              bool substitute = true)
+/*
+An optimal alignment of arrays a and b in linear memory, returns its cost.
+ops gets one letter per step: '=' match, 'X' substitution, 'D' deletion of
+an element of a, 'I' insertion of an element of b. Without substitute it is
+an LCS diff of deletions and insertions only.
+*/
+{
+    std::vector<int> a, b, slot;
 
-    delete[] f;
+    slot.assign(detail::__symbol_ids(A, n1, B, n2, a, b), -1);
+    ops.clear();
 
-    return f[n1][n2];
+    return detail::__align(a.data(), n1, b.data(), n2, substitute, slot, ops);
 }
 
 template <int n>
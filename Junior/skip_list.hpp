@@ -13,11 +13,155 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <cstdlib>
 #include <map>
+#include <new>
 #include <random>
+#include <utility>
+#include <vector>
 
 namespace Octinc {
+namespace detail {
+inline uint64_t __thread_random()
+/*
+xorshift64* generator private to the calling thread, seeded once per thread.
+*/
+{
+    static thread_local uint64_t state = 0;
+
+    if (state == 0) {
+        std::random_device rd;
+        state = ((uint64_t)rd() << 32 | rd()) ^ (uint64_t)(uintptr_t)&state;
+        state |= 1;
+    }
+
+    state ^= state >> 12, state ^= state << 25, state ^= state >> 27;
+
+    return state * 0x2545F4914F6CDD1Dull;
+}
+
+class __epoch
+/*
+Epoch-based reclamation for the lock-free containers. A guard pins the
+global epoch while a thread reads shared nodes; a node retired in epoch e is
+freed by its retiring thread once the epoch reaches e + 2, when every thread
+that could have seen it linked has left its guard.
+*/
+{
+   private:
+    struct record {
+        std::atomic<unsigned> local;  // epoch << 1 | pinned
+        std::atomic<bool> owned;
+        record* next;
+        unsigned depth, seen, retired;
+        std::vector<std::pair<void*, void (*)(void*)> > limbo[3];
+
+        record()
+            : local(0), owned(true), next(0), depth(0), seen(0), retired(0) {}
+    };
+
+    struct holder {
+        record* r;
+
+        holder() : r(0) {}
+        ~holder() {
+            if (r) r->owned.store(false);
+        }
+    };
+
+    std::atomic<unsigned> global;
+    std::atomic<record*> records;
+
+    __epoch() : global(0), records(0) {}
+
+    static __epoch& domain() {
+        // Never destroyed: threads may still retire while statics go away.
+        static __epoch* d = new __epoch;
+        return *d;
+    }
+
+    static record* self() {
+        static thread_local holder h;
+
+        if (h.r) return h.r;
+
+        __epoch& d = domain();
+
+        for (record* r = d.records.load(); r; r = r->next) {
+            bool idle = false;
+
+            if (r->owned.compare_exchange_strong(idle, true)) return h.r = r;
+        }
+
+        record* r = new record;
+        r->next = d.records.load();
+
+        while (!d.records.compare_exchange_weak(r->next, r))
+            ;
+
+        return h.r = r;
+    }
+
+    static void flush(std::vector<std::pair<void*, void (*)(void*)> >& list) {
+        for (size_t i = 0; i < list.size(); ++i) list[i].second(list[i].first);
+
+        list.clear();
+    }
+
+    static bool advance(unsigned e) {
+        __epoch& d = domain();
+
+        for (record* r = d.records.load(); r; r = r->next) {
+            unsigned l = r->local.load();
+
+            if ((l & 1) && (l >> 1) != e) return false;
+        }
+
+        return d.global.compare_exchange_strong(e, e + 1);
+    }
+
+   public:
+    class guard {
+       private:
+        record* r;
+
+       public:
+        guard() : r(self()) {
+            if (r->depth++) return;
+
+            // A stale pin only holds the epoch back, so one read is enough.
+            unsigned e = domain().global.load();
+            r->local.store(e << 1 | 1);
+
+            if (r->seen != e) r->seen = e, flush(r->limbo[(e + 1) % 3]);
+        }
+
+        ~guard() {
+            if (--r->depth == 0) r->local.store(r->seen << 1);
+        }
+
+        guard(const guard&) = delete;
+        guard& operator=(const guard&) = delete;
+    };
+
+    static void retire(void* p, void (*del)(void*))
+    /*
+    Hand over an unlinked node; del(p) runs once no reader can hold it.
+    Must be called inside a guard.
+    */
+    {
+        record* r = self();
+        unsigned e = domain().global.load();
+
+        r->limbo[e % 3].push_back(std::make_pair(p, del));
+
+        if (++r->retired % 64 == 0) advance(e);
+    }
+};
+}  // namespace detail
+
 template <typename __Key, typename __Value, typename __Cmp = std::less<__Key>,
           uint32_t __Lvl = 15>
 class skip_list {
@@ -151,15 +295,8 @@ skip_list<__Key, __Value, __Cmp, __Lvl>::~skip_list() {
 
 template <typename __Key, typename __Value, typename __Cmp, uint32_t __Lvl>
 uint32_t skip_list<__Key, __Value, __Cmp, __Lvl>::randomLevel() {
-    uint32_t lev = 0;
-    std::random_device rd;
-
-    while (true) {
-        if (rd() % 2 == 0)
-            ++lev;
-        else
-            break;
-    }
+    // The top bit keeps the argument of ctz non-zero.
+    uint32_t lev = __builtin_ctzll(~detail::__thread_random() | 1ull << 63);
 
     return lev < __Lvl ? lev : __Lvl - 1;
 }
@@ -209,7 +346,7 @@ bool skip_list<__Key, __Value, __Cmp, __Lvl>::insert(const __Key key,
 template <typename __Key, typename __Value, typename __Cmp, uint32_t __Lvl>
 bool skip_list<__Key, __Value, __Cmp, __Lvl>::remove(const __Key key,
                                                      __Value& tot) {
-    Node *update[__Lvl], p = header;
+    Node *update[__Lvl], *p = header;
     __Cmp _cmp;
 
     for (int i = level; i >= 0; --i) {
@@ -294,6 +431,323 @@ bool skip_list<__Key, __Value, __Cmp, __Lvl>::search(const __Key key,
 
     return false;
 }
+
+template <typename __Key, typename __Value, typename __Cmp = std::less<__Key>,
+          uint32_t __Lvl = 24>
+class concurrent_skip_list
+/*
+Lock-free ordered map for many threads. Every level is a CAS-linked list
+whose next pointers carry a deletion mark in the low bit (Herlihy and Shavit);
+unlinked nodes are freed through epoch-based reclamation. Every member but
+the destructor may be called concurrently. A value is fixed once inserted.
+*/
+{
+   private:
+    struct Node {
+        __Key key;
+        __Value val;
+        std::atomic<int> owners;  // the inserter and the remover
+        uint32_t height;
+        std::atomic<uintptr_t> next[1];
+    };
+
+    mutable std::atomic<uintptr_t> head[__Lvl];
+    std::atomic<size_t> list_size;
+    __Cmp _cmp;
+
+    static_assert(__Lvl >= 1 && __Lvl <= 64,
+                  "concurrent_skip_list: 1..64 levels");
+
+    static Node* ptr(uintptr_t p) { return (Node*)(p & ~(uintptr_t)1); }
+
+    static bool marked(uintptr_t p) { return p & 1; }
+
+    std::atomic<uintptr_t>* link(Node* p, uint32_t i) const {
+        return p ? &p->next[i] : &head[i];
+    }
+
+    static Node* new_node(const __Key& key, const __Value& val,
+                          uint32_t height);
+    static void delete_node(void* p);
+    void release(Node* p) {
+        if (--p->owners == 0) detail::__epoch::retire(p, delete_node);
+    }
+
+    bool find(const __Key& key, Node** preds, Node** succs);
+    /*
+    Position of key on every level, unlinking marked nodes on the way;
+    returns whether succs[0] holds key.
+    */
+    Node* lower_bound(const __Key& key) const;
+    /*
+    First live node not less than key, without writing anything.
+    */
+
+   public:
+    concurrent_skip_list();
+    ~concurrent_skip_list();
+
+    concurrent_skip_list(const concurrent_skip_list&) = delete;
+    concurrent_skip_list& operator=(const concurrent_skip_list&) = delete;
+
+    bool insert(const __Key& key, const __Value& val);
+    /*
+    Insert the key and the value, return false (and keep the old value) if
+    the key was present.
+    */
+    bool remove(const __Key& key, __Value& tot);
+    /*
+    Delete the key, store its value in tot, return whether it was present.
+    */
+    bool remove(const __Key& key) {
+        __Value tot;
+        return remove(key, tot);
+    }
+
+    bool search(const __Key& key, __Value& tot) const;
+    /*
+    Find the value of the key, store it in tot, return whether it exists.
+    */
+    bool contains(const __Key& key) const {
+        __Value tot;
+        return search(key, tot);
+    }
+
+    template <typename _Func>
+    void range(const __Key& lo, const __Key& hi, _Func f) const
+    /*
+    Call f(key, value) in order for the keys in [lo, hi). Keys inserted or
+    removed meanwhile may or may not be seen.
+    */
+    {
+        detail::__epoch::guard g;
+
+        for (Node* p = lower_bound(lo); p && _cmp(p->key, hi);
+             p = ptr(p->next[0].load()))
+            if (!marked(p->next[0].load())) f(p->key, p->val);
+    }
+
+    template <typename _Func>
+    void for_each(_Func f) const
+    /*
+    Call f(key, value) in order for every key, as range() does.
+    */
+    {
+        detail::__epoch::guard g;
+
+        for (Node* p = ptr(head[0].load()); p; p = ptr(p->next[0].load()))
+            if (!marked(p->next[0].load())) f(p->key, p->val);
+    }
+
+    size_t size() const { return list_size.load(); }
+
+    bool empty() const { return size() == 0; }
+};
+
+template <typename __Key, typename __Value, typename __Cmp, uint32_t __Lvl>
+concurrent_skip_list<__Key, __Value, __Cmp, __Lvl>::concurrent_skip_list()
+    : list_size(0) {
+    for (uint32_t i = 0; i < __Lvl; ++i) head[i].store(0);
+}
+
+template <typename __Key, typename __Value, typename __Cmp, uint32_t __Lvl>
+concurrent_skip_list<__Key, __Value, __Cmp, __Lvl>::~concurrent_skip_list() {
+    Node* p = ptr(head[0].load());
+
+    while (p) {
+        Node* q = ptr(p->next[0].load());
+        delete_node(p);
+        p = q;
+    }
+}
+
+template <typename __Key, typename __Value, typename __Cmp, uint32_t __Lvl>
+typename concurrent_skip_list<__Key, __Value, __Cmp, __Lvl>::Node*
+concurrent_skip_list<__Key, __Value, __Cmp, __Lvl>::new_node(
+    const __Key& key, const __Value& val, uint32_t height) {
+    Node* p = (Node*)malloc(sizeof(Node) +
+                            (height - 1) * sizeof(std::atomic<uintptr_t>));
+
+    new (&p->key) __Key(key);
+    new (&p->val) __Value(val);
+    new (&p->owners) std::atomic<int>(2);
+    p->height = height;
+
+    for (uint32_t i = 0; i < height; ++i)
+        new (&p->next[i]) std::atomic<uintptr_t>(0);
+
+    return p;
+}
+
+template <typename __Key, typename __Value, typename __Cmp, uint32_t __Lvl>
+void concurrent_skip_list<__Key, __Value, __Cmp, __Lvl>::delete_node(void* q) {
+    Node* p = (Node*)q;
+    p->key.~__Key();
+    p->val.~__Value();
+    free(p);
+}
+
+template <typename __Key, typename __Value, typename __Cmp, uint32_t __Lvl>
+bool concurrent_skip_list<__Key, __Value, __Cmp, __Lvl>::find(const __Key& key,
+                                                              Node** preds,
+                                                              Node** succs) {
+retry:
+    Node* pred = 0;
+
+    for (int i = __Lvl - 1; i >= 0; --i) {
+        Node* curr = ptr(link(pred, i)->load());
+
+        while (curr) {
+            uintptr_t succ = curr->next[i].load();
+
+            // curr is being deleted: unlink it here, or start over if pred
+            // changed under us.
+            while (marked(succ)) {
+                uintptr_t expect = (uintptr_t)curr;
+
+                if (!link(pred, i)->compare_exchange_strong(expect, succ & ~1))
+                    goto retry;
+
+                if (!(curr = ptr(succ))) break;
+
+                succ = curr->next[i].load();
+            }
+
+            if (!curr || !_cmp(curr->key, key)) break;
+
+            pred = curr, curr = ptr(succ);
+        }
+
+        preds[i] = pred, succs[i] = curr;
+    }
+
+    return succs[0] && !_cmp(key, succs[0]->key);
+}
+
+template <typename __Key, typename __Value, typename __Cmp, uint32_t __Lvl>
+typename concurrent_skip_list<__Key, __Value, __Cmp, __Lvl>::Node*
+concurrent_skip_list<__Key, __Value, __Cmp, __Lvl>::lower_bound(
+    const __Key& key) const {
+    Node *pred = 0, *curr = 0;
+
+    for (int i = __Lvl - 1; i >= 0; --i) {
+        curr = ptr(link(pred, i)->load());
+
+        while (curr) {
+            uintptr_t succ = curr->next[i].load();
+
+            if (marked(succ))
+                curr = ptr(succ);
+            else if (_cmp(curr->key, key))
+                pred = curr, curr = ptr(succ);
+            else
+                break;
+        }
+    }
+
+    return curr;
+}
+
+template <typename __Key, typename __Value, typename __Cmp, uint32_t __Lvl>
+bool concurrent_skip_list<__Key, __Value, __Cmp, __Lvl>::insert(
+    const __Key& key, const __Value& val) {
+    detail::__epoch::guard g;
+    Node *preds[__Lvl], *succs[__Lvl], *p = 0;
+    const uint32_t height =
+        1 + __builtin_ctzll(detail::__thread_random() | 1ull << (__Lvl - 1));
+
+    while (true) {
+        if (find(key, preds, succs)) {
+            if (p) delete_node(p);
+
+            return false;
+        }
+
+        if (!p) p = new_node(key, val, height);
+
+        for (uint32_t i = 0; i < height; ++i)
+            p->next[i].store((uintptr_t)succs[i], std::memory_order_relaxed);
+
+        uintptr_t expect = (uintptr_t)succs[0];
+
+        if (link(preds[0], 0)->compare_exchange_strong(expect, (uintptr_t)p))
+            break;
+    }
+
+    ++list_size;
+
+    // The node is in; link the upper levels unless a remover marks it first.
+    for (uint32_t i = 1; i < height; ++i)
+        while (true) {
+            uintptr_t old = p->next[i].load();
+
+            if (marked(old) ||
+                !p->next[i].compare_exchange_strong(old, (uintptr_t)succs[i]))
+                goto linked;
+
+            uintptr_t expect = (uintptr_t)succs[i];
+
+            if (link(preds[i], i)->compare_exchange_strong(expect,
+                                                           (uintptr_t)p))
+                break;
+
+            find(key, preds, succs);
+        }
+
+linked:
+    // A remover may have run its unlinking find before some level was
+    // linked, so sweep again before letting go.
+    if (marked(p->next[0].load())) find(key, preds, succs);
+
+    release(p);
+    return true;
+}
+
+template <typename __Key, typename __Value, typename __Cmp, uint32_t __Lvl>
+bool concurrent_skip_list<__Key, __Value, __Cmp, __Lvl>::remove(
+    const __Key& key, __Value& tot) {
+    detail::__epoch::guard g;
+    Node *preds[__Lvl], *succs[__Lvl];
+
+    if (!find(key, preds, succs)) return false;
+
+    Node* p = succs[0];
+
+    for (uint32_t i = p->height - 1; i >= 1; --i) {
+        uintptr_t s = p->next[i].load();
+
+        while (!marked(s) && !p->next[i].compare_exchange_weak(s, s | 1))
+            ;
+    }
+
+    // Marking level 0 is the linearisation point, only one remover wins.
+    uintptr_t s = p->next[0].load();
+
+    do
+        if (marked(s)) return false;
+    while (!p->next[0].compare_exchange_weak(s, s | 1));
+
+    tot = p->val;
+    --list_size;
+    find(key, preds, succs);
+    release(p);
+
+    return true;
+}
+
+template <typename __Key, typename __Value, typename __Cmp, uint32_t __Lvl>
+bool concurrent_skip_list<__Key, __Value, __Cmp, __Lvl>::search(
+    const __Key& key, __Value& tot) const {
+    detail::__epoch::guard g;
+    Node* p = lower_bound(key);
+
+    if (p && !_cmp(key, p->key)) {
+        tot = p->val;
+        return true;
+    }
+
+    return false;
+}
 }  // namespace Octinc
 
 #endif
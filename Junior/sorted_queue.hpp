@@ -14,21 +14,27 @@
 
 #include <algorithm>
 #include <cstring>
-#include <deque>
+
+#include "tiered_vector.hpp"
 
 namespace Octinc {
 template <typename __Tp>
 class sorted_queue {
    public:
-    typedef typename std::deque<__Tp>::value_type value_type;
-    typedef typename std::deque<__Tp>::size_type size_type;
-    typedef typename std::deque<__Tp>::reference reference;
-    typedef typename std::deque<__Tp>::const_reference const_reference;
-    typedef typename std::deque<__Tp>::iterator iterator;
-    typedef typename std::deque<__Tp>::const_iterator const_iterator;
+    typedef typename tiered_vector<__Tp>::value_type value_type;
+    typedef typename tiered_vector<__Tp>::size_type size_type;
+    typedef typename tiered_vector<__Tp>::reference reference;
+    typedef typename tiered_vector<__Tp>::const_reference const_reference;
+    typedef typename tiered_vector<__Tp>::iterator iterator;
+    typedef typename tiered_vector<__Tp>::const_iterator const_iterator;
 
    protected:
-    std::deque<__Tp> __Main_Q;
+    tiered_vector<__Tp> __Main_Q;
+    /*
+    A tiered_vector rather than a deque: push and remove are O(sqrt n)
+    instead of O(n), while indexing stays O(1). Like every tiered_vector
+    element, __Tp has to be default-constructible.
+    */
 
    public:
     sorted_queue() {}
@@ -76,7 +82,8 @@ class sorted_queue {
     }
 
     void remove(const __Tp& __Val_) {
-        auto __interval_ = equal_range(this->begin(), this->end(), __Val_);
+        auto __interval_ =
+            std::equal_range(this->begin(), this->end(), __Val_);
         this->erase(__interval_.first, __interval_.second);
     }
 
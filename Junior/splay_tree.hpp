@@ -14,6 +14,9 @@
 
 #include <cstdint>
 #include <iostream>
+#include <vector>
+
+#include "memory_pool.hpp"
 
 namespace Octinc {
 template <typename __Tp, typename __Cmp = std::less<__Tp> >
@@ -88,7 +91,7 @@ struct splay_tree<__Tp, __Cmp>::Node {
 };
 
 template <typename __Tp, typename __Cmp>
-splay_tree<__Tp, __Cmp>::splay_tree() : _root(nullptr) {}
+splay_tree<__Tp, __Cmp>::splay_tree() : siz(0), _root(nullptr) {}
 
 template <typename __Tp, typename __Cmp>
 splay_tree<__Tp, __Cmp>::~splay_tree() {
@@ -325,11 +328,12 @@ template <typename __Tp, typename __Cmp>
 typename splay_tree<__Tp, __Cmp>::iterator splay_tree<__Tp, __Cmp>::insert(
     __Tp key) {
     Node* z = nullptr;
-    ++siz;
 
     if ((z = new Node(key, nullptr, nullptr)) == nullptr)
         return iterator(nullptr);
 
+    if (search(_root, key) == nullptr) ++siz;
+
     _root = insert(_root, z);
     _root = splay(_root, key);
     return iterator(_root);
@@ -360,7 +364,8 @@ typename splay_tree<__Tp, __Cmp>::Node* splay_tree<__Tp, __Cmp>::remove(
 template <typename __Tp, typename __Cmp>
 typename splay_tree<__Tp, __Cmp>::iterator splay_tree<__Tp, __Cmp>::remove(
     __Tp key) {
-    --siz;
+    if (search(_root, key) != nullptr) --siz;
+
     _root = remove(_root, key);
     return iterator(_root);
 }
@@ -378,6 +383,404 @@ void splay_tree<__Tp, __Cmp>::clear(Node*& tree) {
 template <typename __Tp, typename __Cmp>
 void splay_tree<__Tp, __Cmp>::clear() {
     clear(_root);
+    _root = nullptr;
+    siz = 0;
+}
+
+template <typename __Tp>
+class splay_sequence
+/*
+A sequence kept in a splay tree keyed by position, splayed top-down (no
+parent pointers, no recursion), with lazy interval addition and reversal
+and interval sums. Recently used positions stay near the root, so skewed
+access patterns cost far less than O(log n). Positions are 1-based and
+intervals [l, r] inclusive, as in treap.
+*/
+{
+   private:
+    struct Node {
+        __Tp val, sum, addflag;
+        size_t s;
+        bool revflag;
+        Node *lc, *rc;
+
+        Node(const __Tp& v)
+            : val(v),
+              sum(v),
+              addflag(__Tp(0)),
+              s(1),
+              revflag(false),
+              lc(nullptr),
+              rc(nullptr) {}
+    };
+
+    Node* _root;
+    shared_pool<Node, 1 << 16> _pool;
+    std::vector<Node*> _left, _right;
+
+    static size_t size(Node* x) { return x ? x->s : 0; }
+
+    static void apply_add(Node* x, const __Tp& v) {
+        if (!x) return;
+
+        x->val += v;
+        x->sum += v * __Tp(x->s);
+        x->addflag += v;
+    }
+
+    static void apply_rev(Node* x) {
+        if (!x) return;
+
+        std::swap(x->lc, x->rc);
+        x->revflag ^= 1;
+    }
+
+    static void pushdown(Node* x)
+    /*
+    The tags of a node are already applied to itself and wait for its
+    children.
+    */
+    {
+        if (x->addflag != __Tp(0)) {
+            apply_add(x->lc, x->addflag);
+            apply_add(x->rc, x->addflag);
+            x->addflag = __Tp(0);
+        }
+
+        if (x->revflag) {
+            apply_rev(x->lc);
+            apply_rev(x->rc);
+            x->revflag = false;
+        }
+    }
+
+    static void maintain(Node* x) {
+        x->s = 1 + size(x->lc) + size(x->rc);
+        x->sum = x->val;
+
+        if (x->lc) x->sum += x->lc->sum;
+        if (x->rc) x->sum += x->rc->sum;
+    }
+
+    Node* splay(Node*, size_t);
+    void split(Node*, size_t, Node*&, Node*&);
+    Node* merge(Node*, Node*);
+    template <typename _It>
+    Node* build(_It&, size_t);
+    void clear(Node*);
+
+   public:
+    splay_sequence() : _root(nullptr) {}
+
+    splay_sequence(const splay_sequence& other) : _root(nullptr) {
+        *this = other;
+    }
+
+    splay_sequence& operator=(const splay_sequence& other) {
+        if (&other != this) {
+            std::vector<__Tp> v;
+            other.for_each([&](const __Tp& x) { v.push_back(x); });
+            assign(v.begin(), v.end());
+        }
+
+        return *this;
+    }
+
+    ~splay_sequence() { clear(_root); }
+
+    size_t size() const { return size(_root); }
+
+    bool empty() const { return _root == nullptr; }
+
+    __Tp operator[](size_t);
+    /*
+    The ith value, splaying it to the root.
+    */
+
+    void insert(const __Tp);
+    /*
+    Append a value.
+    */
+
+    void insert_at(size_t, const __Tp);
+    /*
+    Insert a value after the first pos values.
+    */
+
+    template <typename _It>
+    void assign(_It, _It);
+    /*
+    Replace the sequence with a range of values, building a balanced tree in
+    O(n).
+    */
+
+    void erase(size_t, size_t);
+    /*
+    Remove the interval [l, r].
+    */
+
+    void add_update(size_t, size_t, const __Tp);
+    /*
+    Interval addition.
+    */
+
+    void reverse(size_t, size_t);
+    /*
+    Interval reversal.
+    */
+
+    __Tp query(size_t, size_t);
+    /*
+    Interval summation.
+    */
+
+    void split(size_t, splay_sequence&);
+    /*
+    Keep the first k values and move the rest into another sequence.
+    */
+
+    void concat(splay_sequence&);
+    /*
+    Append another sequence, which is left empty.
+    */
+
+    template <typename _Func>
+    void for_each(_Func) const;
+    /*
+    Call f on every value in order.
+    */
+
+    void clear() {
+        clear(_root);
+        _root = nullptr;
+    }
+};
+
+template <typename __Tp>
+typename splay_sequence<__Tp>::Node* splay_sequence<__Tp>::splay(Node* t,
+                                                                 size_t k)
+/*
+Top-down splay of the node at 0-based position k. Nodes are hung on the
+left and right trees on the way down with stale sums, and maintained
+bottom-up once the tree is reassembled.
+*/
+{
+    Node N(__Tp(0)), *l = &N, *r = &N, *c;
+
+    _left.clear(), _right.clear();
+
+    for (;;) {
+        pushdown(t);
+        size_t sl = size(t->lc);
+
+        if (k < sl) {
+            c = t->lc;
+            pushdown(c);
+
+            if (k < size(c->lc)) {
+                t->lc = c->rc, c->rc = t;
+                maintain(t);
+                t = c;
+            }
+
+            r->lc = t, r = t;
+            _right.push_back(t);
+            t = t->lc;
+        } else if (k > sl) {
+            k -= sl + 1;
+            c = t->rc;
+            pushdown(c);
+
+            if (k > size(c->lc)) {
+                k -= size(c->lc) + 1;
+                t->rc = c->lc, c->lc = t;
+                maintain(t);
+                t = c;
+            }
+
+            l->rc = t, l = t;
+            _left.push_back(t);
+            t = t->rc;
+        } else
+            break;
+    }
+
+    l->rc = t->lc, r->lc = t->rc;
+    t->lc = N.rc, t->rc = N.lc;
+
+    for (size_t i = _left.size(); i-- > 0;) maintain(_left[i]);
+    for (size_t i = _right.size(); i-- > 0;) maintain(_right[i]);
+
+    maintain(t);
+    return t;
+}
+
+template <typename __Tp>
+void splay_sequence<__Tp>::split(Node* t, size_t k, Node*& l, Node*& r)
+/*
+The first k values go to l, the rest to r.
+*/
+{
+    if (k == 0) {
+        l = nullptr, r = t;
+        return;
+    }
+
+    if (k >= size(t)) {
+        l = t, r = nullptr;
+        return;
+    }
+
+    t = splay(t, k);
+    l = t->lc, t->lc = nullptr;
+    maintain(t);
+    r = t;
+}
+
+template <typename __Tp>
+typename splay_sequence<__Tp>::Node* splay_sequence<__Tp>::merge(Node* l,
+                                                                 Node* r) {
+    if (!l) return r;
+    if (!r) return l;
+
+    l = splay(l, size(l) - 1);
+    l->rc = r;
+    maintain(l);
+    return l;
+}
+
+template <typename __Tp>
+template <typename _It>
+typename splay_sequence<__Tp>::Node* splay_sequence<__Tp>::build(_It& first,
+                                                                 size_t n) {
+    if (n == 0) return nullptr;
+
+    Node* lc = build(first, n / 2);
+    Node* x = _pool.create(*first);
+    ++first;
+    x->lc = lc;
+    x->rc = build(first, n - n / 2 - 1);
+    maintain(x);
+    return x;
+}
+
+template <typename __Tp>
+void splay_sequence<__Tp>::clear(Node* x) {
+    std::vector<Node*> stk;
+
+    for (stk.push_back(x); !stk.empty();) {
+        x = stk.back();
+        stk.pop_back();
+
+        if (!x) continue;
+
+        stk.push_back(x->lc), stk.push_back(x->rc);
+        _pool.dispose(x);
+    }
+}
+
+template <typename __Tp>
+__Tp splay_sequence<__Tp>::operator[](size_t i) {
+    _root = splay(_root, i - 1);
+    return _root->val;
+}
+
+template <typename __Tp>
+void splay_sequence<__Tp>::insert(const __Tp x) {
+    _root = merge(_root, _pool.create(x));
+}
+
+template <typename __Tp>
+void splay_sequence<__Tp>::insert_at(size_t pos, const __Tp x) {
+    Node *l, *r;
+    split(_root, pos, l, r);
+    _root = merge(merge(l, _pool.create(x)), r);
+}
+
+template <typename __Tp>
+template <typename _It>
+void splay_sequence<__Tp>::assign(_It first, _It last) {
+    std::vector<__Tp> v(first, last);
+    typename std::vector<__Tp>::iterator it = v.begin();
+
+    clear(_root);
+    _root = build(it, v.size());
+}
+
+template <typename __Tp>
+void splay_sequence<__Tp>::erase(size_t l, size_t r) {
+    Node *a, *b, *c;
+    split(_root, l - 1, a, b);
+    split(b, r - l + 1, b, c);
+    clear(b);
+    _root = merge(a, c);
+}
+
+template <typename __Tp>
+void splay_sequence<__Tp>::add_update(size_t l, size_t r, const __Tp v) {
+    Node *a, *b, *c;
+    split(_root, l - 1, a, b);
+    split(b, r - l + 1, b, c);
+    apply_add(b, v);
+    _root = merge(merge(a, b), c);
+}
+
+template <typename __Tp>
+void splay_sequence<__Tp>::reverse(size_t l, size_t r) {
+    Node *a, *b, *c;
+    split(_root, l - 1, a, b);
+    split(b, r - l + 1, b, c);
+    apply_rev(b);
+    _root = merge(merge(a, b), c);
+}
+
+template <typename __Tp>
+__Tp splay_sequence<__Tp>::query(size_t l, size_t r) {
+    Node *a, *b, *c;
+    split(_root, l - 1, a, b);
+    split(b, r - l + 1, b, c);
+    __Tp ans = b ? b->sum : __Tp(0);
+    _root = merge(merge(a, b), c);
+    return ans;
+}
+
+template <typename __Tp>
+void splay_sequence<__Tp>::split(size_t k, splay_sequence& other) {
+    if (&other == this) return;
+
+    Node *l, *r;
+    split(_root, k, l, r);
+    other.clear();
+    _root = l;
+    other._root = r;
+    other._pool = _pool;
+}
+
+template <typename __Tp>
+void splay_sequence<__Tp>::concat(splay_sequence& other) {
+    if (&other == this) return;
+
+    _pool.unite(other._pool);
+    _root = merge(_root, other._root);
+    other._root = nullptr;
+}
+
+template <typename __Tp>
+template <typename _Func>
+void splay_sequence<__Tp>::for_each(_Func f) const {
+    std::vector<Node*> stk;
+
+    for (Node* x = _root; x || !stk.empty();) {
+        for (; x; x = x->lc) {
+            pushdown(x);
+            stk.push_back(x);
+        }
+
+        x = stk.back();
+        stk.pop_back();
+        f(x->val);
+        x = x->rc;
+    }
 }
 
 }  // namespace Octinc
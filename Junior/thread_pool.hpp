@@ -83,14 +83,14 @@ class thread_pool : public nocopyable {
     bool _running;
 };
 
-thread_pool::thread_pool(const std::string& name)
+inline thread_pool::thread_pool(const std::string& name)
     : _name(name), _maxQueueSize(0), _running(false) {}
 
-thread_pool::~thread_pool() {
+inline thread_pool::~thread_pool() {
     if (_running) stop();
 }
 
-void thread_pool::start(int numThreads) {
+inline void thread_pool::start(int numThreads) {
     assert(_threads.empty());
     _running = true;
     _threads.reserve(numThreads);
@@ -99,15 +99,18 @@ void thread_pool::start(int numThreads) {
         _threads.push_back(std::thread(&thread_pool::__run, this));
 }
 
-void thread_pool::stop() {
-    std::unique_lock<std::mutex> lock(_mutex);
-    _running = false;
-    _notEmpty.notify_all();
+inline void thread_pool::stop() {
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _running = false;
+        _notEmpty.notify_all();
+    }
 
+    // Joining under the lock would keep the workers from waking up.
     for (size_t i = 0; i < _threads.size(); ++i) _threads[i].join();
 }
 
-void thread_pool::run(const Task& f) {
+inline void thread_pool::run(const Task& f) {
     if (_threads.empty())
         f();
     else {
@@ -121,7 +124,7 @@ void thread_pool::run(const Task& f) {
     }
 }
 
-thread_pool::Task thread_pool::take() {
+inline thread_pool::Task thread_pool::take() {
     std::unique_lock<std::mutex> lock(_mutex);
 
     while (_queue.empty() && _running) _notEmpty.wait(lock);
@@ -138,11 +141,11 @@ thread_pool::Task thread_pool::take() {
     return task;
 }
 
-bool thread_pool::full() {
+inline bool thread_pool::full() {
     return _maxQueueSize > 0 && _queue.size() >= _maxQueueSize;
 }
 
-void thread_pool::__run() {
+inline void thread_pool::__run() {
     try {
         while (_running) {
             Task task = take();
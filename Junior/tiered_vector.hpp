@@ -0,0 +1,397 @@
+/* Octinc includes library.
+ *
+ * Copyright (C) 2019-2019 Octinc Repositories, WeKw team.
+ *
+ * The source uses the GNU AFFERO GENERAL PUBLIC LICENSE Version 3,
+ * please follow the licence.
+ */
+#ifndef OCTINC_TIERED_VECTOR__
+#define OCTINC_TIERED_VECTOR__
+
+#if __cplusplus < 201103L
+#error "should use C++11 implementation"
+#endif
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Octinc {
+template <typename __Tp, typename __Alloc = std::allocator<__Tp> >
+class tiered_vector
+/*
+A sequence with O(1) indexed access, O(1) amortised push and pop at both
+ends, and O(sqrt n) insert and erase anywhere (Goodrich and Kloss).
+Elements sit in blocks of B = 2^k slots, each a ring buffer; all blocks but
+the first and last are full. Inserting shifts within one block, then passes
+one element through every later block by rotating its ring, O(B + n / B);
+B follows sqrt(n) as the size changes.
+Blocks are filled with default-constructed values up front, so __Tp has
+to be default-constructible, unlike for std::vector.
+*/
+{
+   public:
+    typedef __Tp value_type;
+    typedef __Alloc allocator_type;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef __Tp& reference;
+    typedef const __Tp& const_reference;
+    typedef __Tp* pointer;
+    typedef const __Tp* const_pointer;
+
+    template <bool Const>
+    class basic_iterator;
+
+    typedef basic_iterator<false> iterator;
+    typedef basic_iterator<true> const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+   private:
+    typedef std::vector<__Tp, __Alloc> block;
+
+    enum { MinShift = 6 };
+
+    std::vector<block> _blocks;
+    std::vector<size_type> _heads;
+    size_type _shift, _off, _size;
+    /*
+    Block b holds logical slots [b * B, (b + 1) * B); slot k of it is
+    _blocks[b][(_heads[b] + k) % B]. Element i is at logical slot _off + i.
+    */
+    __Alloc _alloc;
+
+    size_type mask() const { return (size_type(1) << _shift) - 1; }
+
+    __Tp& slot(size_type b, size_type k) {
+        return _blocks[b][(_heads[b] + k) & mask()];
+    }
+
+    const __Tp& slot(size_type b, size_type k) const {
+        return _blocks[b][(_heads[b] + k) & mask()];
+    }
+
+    size_type tail() const
+    /*
+    The number of used logical slots of the last block.
+    */
+    {
+        return _off + _size - ((_blocks.size() - 1) << _shift);
+    }
+
+    void add_block(size_type at) {
+        _blocks.insert(_blocks.begin() + at,
+                       block(size_type(1) << _shift, __Tp(), _alloc));
+        _heads.insert(_heads.begin() + at, 0);
+    }
+
+    void reshape(size_type shift)
+    /*
+    Move everything into blocks of 2^shift slots.
+    */
+    {
+        std::vector<block> blocks;
+        size_type B = size_type(1) << shift;
+
+        for (size_type i = 0; i < _size; ++i) {
+            if ((i & (B - 1)) == 0) {
+                blocks.push_back(block(_alloc));
+                blocks.back().reserve(B);
+            }
+
+            blocks.back().push_back(std::move((*this)[i]));
+        }
+
+        if (!blocks.empty()) blocks.back().resize(B);
+
+        _blocks.swap(blocks);
+        _heads.assign(_blocks.size(), 0);
+        _shift = shift, _off = 0;
+    }
+
+    void balance() {
+        size_type B = size_type(1) << _shift;
+
+        if (_size > 4 * B * B)
+            reshape(_shift + 1);
+        else if (_shift > MinShift && _size < B * B / 16)
+            reshape(_shift - 1);
+    }
+
+   public:
+    template <bool Const>
+    class basic_iterator {
+       private:
+        typedef typename std::conditional<Const, const tiered_vector,
+                                          tiered_vector>::type container;
+
+        container* _c;
+        size_type _i;
+
+        friend class tiered_vector;
+
+       public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef __Tp value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef typename std::conditional<Const, const __Tp*, __Tp*>::type
+            pointer;
+        typedef typename std::conditional<Const, const __Tp&, __Tp&>::type
+            reference;
+
+        basic_iterator(container* c = nullptr, size_type i = 0)
+            : _c(c), _i(i) {}
+
+        template <bool C, typename = typename std::enable_if<Const && !C>::type>
+        basic_iterator(const basic_iterator<C>& other)
+            : _c(other._c), _i(other._i) {}
+
+        reference operator*() const { return (*_c)[_i]; }
+        pointer operator->() const { return &(*_c)[_i]; }
+        reference operator[](difference_type n) const { return (*_c)[_i + n]; }
+
+        basic_iterator& operator++() {
+            ++_i;
+            return *this;
+        }
+        basic_iterator& operator--() {
+            --_i;
+            return *this;
+        }
+        basic_iterator operator++(int) { return basic_iterator(_c, _i++); }
+        basic_iterator operator--(int) { return basic_iterator(_c, _i--); }
+
+        basic_iterator& operator+=(difference_type n) {
+            _i += n;
+            return *this;
+        }
+        basic_iterator& operator-=(difference_type n) {
+            _i -= n;
+            return *this;
+        }
+        basic_iterator operator+(difference_type n) const {
+            return basic_iterator(_c, _i + n);
+        }
+        basic_iterator operator-(difference_type n) const {
+            return basic_iterator(_c, _i - n);
+        }
+        friend basic_iterator operator+(difference_type n,
+                                        const basic_iterator& it) {
+            return it + n;
+        }
+        difference_type operator-(const basic_iterator& other) const {
+            return difference_type(_i) - difference_type(other._i);
+        }
+
+        bool operator==(const basic_iterator& other) const {
+            return _i == other._i;
+        }
+        bool operator!=(const basic_iterator& other) const {
+            return _i != other._i;
+        }
+        bool operator<(const basic_iterator& other) const {
+            return _i < other._i;
+        }
+        bool operator>(const basic_iterator& other) const {
+            return _i > other._i;
+        }
+        bool operator<=(const basic_iterator& other) const {
+            return _i <= other._i;
+        }
+        bool operator>=(const basic_iterator& other) const {
+            return _i >= other._i;
+        }
+
+        template <bool C>
+        friend class basic_iterator;
+    };
+
+    explicit tiered_vector(const __Alloc& alloc = __Alloc())
+        : _shift(MinShift), _off(0), _size(0), _alloc(alloc) {}
+
+    reference operator[](size_type i) {
+        size_type p = _off + i;
+        return slot(p >> _shift, p & mask());
+    }
+
+    const_reference operator[](size_type i) const {
+        size_type p = _off + i;
+        return slot(p >> _shift, p & mask());
+    }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, _size); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, _size); }
+
+    reverse_iterator rbegin() { return reverse_iterator(end()); }
+    reverse_iterator rend() { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const {
+        return const_reverse_iterator(end());
+    }
+    const_reverse_iterator rend() const {
+        return const_reverse_iterator(begin());
+    }
+
+    reference front() { return (*this)[0]; }
+    const_reference front() const { return (*this)[0]; }
+    reference back() { return (*this)[_size - 1]; }
+    const_reference back() const { return (*this)[_size - 1]; }
+
+    bool empty() const { return _size == 0; }
+    size_type size() const { return _size; }
+    size_type max_size() const { return std::vector<__Tp>().max_size(); }
+    allocator_type get_allocator() const { return _alloc; }
+
+    void reserve(size_type)
+    /*
+    Blocks are allocated on demand; kept for vector compatibility.
+    */
+    {}
+
+    void clear() {
+        _blocks.clear(), _heads.clear();
+        _shift = MinShift, _off = _size = 0;
+    }
+
+    void push_back(const __Tp& x) {
+        if (((_off + _size) >> _shift) == _blocks.size())
+            add_block(_blocks.size());
+
+        size_type p = _off + _size;
+        slot(p >> _shift, p & mask()) = x;
+        ++_size;
+        balance();
+    }
+
+    void push_front(const __Tp& x) {
+        if (_off == 0) add_block(0), _off = mask() + 1;
+
+        slot(0, --_off) = x;
+        ++_size;
+        balance();
+    }
+
+    void pop_back() {
+        back() = __Tp();
+
+        if (tail() == 1) _blocks.pop_back(), _heads.pop_back();
+
+        if (--_size == 0) clear();
+    }
+
+    void pop_front() {
+        front() = __Tp();
+
+        if (++_off > mask()) {
+            _blocks.erase(_blocks.begin());
+            _heads.erase(_heads.begin());
+            _off = 0;
+        }
+
+        if (--_size == 0) clear();
+    }
+
+    iterator insert(const_iterator pos, const __Tp& x)
+    /*
+    Insert before pos, in O(sqrt n).
+    */
+    {
+        size_type i = pos._i;
+
+        if (i == _size) {
+            push_back(x);
+            return iterator(this, i);
+        }
+
+        if (i == 0) {
+            push_front(x);
+            return iterator(this, i);
+        }
+
+        if (tail() == mask() + 1) add_block(_blocks.size());
+
+        size_type p = _off + i, b = p >> _shift, k = p & mask();
+        size_type last = _blocks.size() - 1, end = b == last ? tail() : mask();
+        __Tp carry = std::move(slot(b, end));
+
+        for (size_type j = end; j > k; --j)
+            slot(b, j) = std::move(slot(b, j - 1));
+
+        slot(b, k) = x;
+
+        // Every later block takes the carry in front and passes on its last.
+        for (size_type c = b + 1; c <= last; ++c) {
+            _heads[c] = (_heads[c] - 1) & mask();
+            std::swap(carry, slot(c, 0));
+        }
+
+        ++_size;
+        balance();
+        return iterator(this, i);
+    }
+
+    iterator erase(const_iterator pos)
+    /*
+    Erase at pos, in O(sqrt n).
+    */
+    {
+        size_type i = pos._i;
+
+        if (i == 0) {
+            pop_front();
+            return begin();
+        }
+
+        if (i + 1 == _size) {
+            pop_back();
+            return end();
+        }
+
+        size_type p = _off + i, b = p >> _shift, k = p & mask();
+        size_type last = _blocks.size() - 1, t = tail();
+        size_type end = b == last ? t - 1 : mask();
+
+        for (size_type j = k; j < end; ++j)
+            slot(b, j) = std::move(slot(b, j + 1));
+
+        // Every later block passes its first to the end of the previous one.
+        for (size_type c = b + 1; c <= last; ++c) {
+            slot(c - 1, mask()) = std::move(slot(c, 0));
+            slot(c, 0) = __Tp();
+            _heads[c] = (_heads[c] + 1) & mask();
+        }
+
+        if (b == last) slot(b, end) = __Tp();
+
+        if (t == 1) _blocks.pop_back(), _heads.pop_back();
+
+        --_size;
+        balance();
+        return iterator(this, i);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    /*
+    Erase [first, last) by moving the rest down, in O(n).
+    */
+    {
+        size_type i = first._i, n = last._i - first._i;
+
+        if (n == 0) return iterator(this, i);
+
+        for (size_type j = i; j + n < _size; ++j)
+            (*this)[j] = std::move((*this)[j + n]);
+
+        while (n--) pop_back();
+
+        return iterator(this, i);
+    }
+};
+}  // namespace Octinc
+
+#endif
@@ -14,11 +14,16 @@
 
 #include <algorithm>
 #include <ctime>
+#include <cstdint>
 #include <iostream>
+#include <memory>
 #include <random>
+#include <vector>
+
+#include "memory_pool.hpp"
 
 namespace Octinc {
-#define mod(x) (Mod == 0 ? x : x % Mod)
+#define mod(x) (Mod == 0 ? (x) : (x) % Mod)
 
 template <typename __Tp, const __Tp Mod = 0>
 /*
@@ -30,14 +35,25 @@ class treap {
     struct Node;
 
     Node* _root;
+    shared_pool<Node, 1 << 16> _pool;
+
     Node* merge(Node*, Node*);
 
     void ranksplit(Node*, const size_t&, Node*&, Node*&);
     void dfs(Node*, std::ostream&);
+    void clear(Node*);
+    Node* copy(const Node*);
+    template <typename _It>
+    Node* build(_It, _It);
 
    public:
-    treap() {}
-    treap(const treap& other) { *this = other; }
+    treap() : _root(nullptr) {}
+    treap(const treap& other) : _root(nullptr) { *this = other; }
+
+    treap& operator=(const treap&);
+    /*
+    Deep copy into this treap's own pool, lazy tags included, in O(n).
+    */
 
     struct iterator;
 
@@ -63,6 +79,46 @@ class treap {
     Insert values.
     */
 
+    iterator insert_at(size_t, const __Tp);
+    /*
+    Insert a value after the first pos values, O(log n).
+    */
+
+    void erase(size_t, size_t);
+    /*
+    Remove the interval [l, r].
+    */
+
+    void reverse(size_t, size_t);
+    /*
+    Interval reversal, applied lazily.
+    */
+
+    void split(size_t, treap&);
+    /*
+    Keep the first k values and move the rest into another treap.
+    */
+
+    void concat(treap&);
+    /*
+    Append another treap, which is left empty, in O(log n).
+    */
+
+    size_t size() const { return Node::size(_root); }
+
+    template <typename _It>
+    void insert(_It, _It);
+    /*
+    Append a range of values: the batch is built in O(k) and merged in with
+    a single O(log n) merge.
+    */
+
+    template <typename _It>
+    void assign(_It, _It);
+    /*
+    Replace the sequence with a range of values in O(n).
+    */
+
     void print(std::ostream&);
     /*
     Print the entire sequence.
@@ -75,21 +131,27 @@ struct treap<__Tp, Mod>::Node {
     size_t pri, s;
     Node *lc, *rc;
     __Tp addflag, mulflag, sum;
-    std::mt19937 rnd;
+    bool revflag;
 
     Node(const __Tp& v = __Tp(), Node* l = nullptr, Node* r = nullptr,
          size_t ss = 1, const __Tp& aff = __Tp(0), const __Tp& mff = __Tp(1))
         : val(v),
           sum(v),
-          pri(rnd()),
+          pri(priority()),
           lc(l),
           rc(r),
           s(ss),
           addflag(aff),
-          mulflag(mff) {}
+          mulflag(mff),
+          revflag(false) {}
 
     static size_t size(Node* ptr) { return ptr != nullptr ? ptr->s : 0; }
 
+    static size_t priority() {
+        static thread_local std::mt19937 rnd(std::random_device{}());
+        return rnd();
+    }
+
     void maintain() {
         s = size(lc) + size(rc) + 1;
         sum = val;
@@ -115,6 +177,13 @@ struct treap<__Tp, Mod>::Node {
 
         addflag = __Tp(0);
         mulflag = __Tp(1);
+
+        if (revflag) {
+            std::swap(lc, rc);
+            if (lc != nullptr) lc->revflag ^= 1;
+            if (rc != nullptr) rc->revflag ^= 1;
+            revflag = false;
+        }
     }
 };
 
@@ -143,6 +212,35 @@ void treap<__Tp, Mod>::dfs(Node* ptr, std::ostream& os) {
     dfs(ptr->rc, os);
 }
 
+template <typename __Tp, const __Tp Mod>
+void treap<__Tp, Mod>::clear(Node* ptr) {
+    if (!ptr) return;
+
+    clear(ptr->lc);
+    clear(ptr->rc);
+    _pool.dispose(ptr);
+}
+
+template <typename __Tp, const __Tp Mod>
+typename treap<__Tp, Mod>::Node* treap<__Tp, Mod>::copy(const Node* ptr) {
+    if (!ptr) return nullptr;
+
+    Node* res = _pool.create(*ptr);
+    res->lc = copy(ptr->lc);
+    res->rc = copy(ptr->rc);
+    return res;
+}
+
+template <typename __Tp, const __Tp Mod>
+treap<__Tp, Mod>& treap<__Tp, Mod>::operator=(const treap& other) {
+    if (&other != this) {
+        clear(_root);
+        _root = copy(other._root);
+    }
+
+    return *this;
+}
+
 template <typename __Tp, const __Tp Mod>
 void treap<__Tp, Mod>::print(std::ostream& os) {
     dfs(_root, os);
@@ -191,7 +289,7 @@ void treap<__Tp, Mod>::ranksplit(Node* nroot, const size_t& k, Node*& ltree,
 
 template <typename __Tp, const __Tp Mod>
 typename treap<__Tp, Mod>::iterator treap<__Tp, Mod>::insert(const __Tp x) {
-    Node* ptr = new Node(x);
+    Node* ptr = _pool.create(x);
 
     if (!_root) {
         _root = ptr;
@@ -202,6 +300,100 @@ typename treap<__Tp, Mod>::iterator treap<__Tp, Mod>::insert(const __Tp x) {
     return ptr;
 }
 
+template <typename __Tp, const __Tp Mod>
+template <typename _It>
+typename treap<__Tp, Mod>::Node* treap<__Tp, Mod>::build(_It first, _It last)
+/*
+Cartesian tree construction: the right spine is kept on a stack, so every
+node is pushed and popped once, and a node is maintained when popped, after
+its subtree is complete.
+*/
+{
+    std::vector<Node*> spine;
+
+    for (; first != last; ++first) {
+        Node *ptr = _pool.create(*first), *last_popped = nullptr;
+
+        while (!spine.empty() && spine.back()->pri > ptr->pri) {
+            last_popped = spine.back();
+            spine.pop_back();
+            last_popped->maintain();
+        }
+
+        ptr->lc = last_popped;
+        if (!spine.empty()) spine.back()->rc = ptr;
+        spine.push_back(ptr);
+    }
+
+    if (spine.empty()) return nullptr;
+
+    for (size_t i = spine.size(); i-- > 0;) spine[i]->maintain();
+
+    return spine[0];
+}
+
+template <typename __Tp, const __Tp Mod>
+template <typename _It>
+void treap<__Tp, Mod>::insert(_It first, _It last) {
+    _root = merge(_root, build(first, last));
+}
+
+template <typename __Tp, const __Tp Mod>
+template <typename _It>
+void treap<__Tp, Mod>::assign(_It first, _It last) {
+    clear(_root);
+    _root = build(first, last);
+}
+
+template <typename __Tp, const __Tp Mod>
+typename treap<__Tp, Mod>::iterator treap<__Tp, Mod>::insert_at(size_t pos,
+                                                                const __Tp x) {
+    Node *ptr = _pool.create(x), *ptr1, *ptr2;
+    ranksplit(_root, pos, ptr1, ptr2);
+    _root = merge(ptr1, merge(ptr, ptr2));
+    return ptr;
+}
+
+template <typename __Tp, const __Tp Mod>
+void treap<__Tp, Mod>::erase(size_t l, size_t r) {
+    Node *ptr, *ptr1, *ptr2;
+    ranksplit(_root, l - 1, ptr1, ptr);
+    ranksplit(ptr, r - l + 1, ptr, ptr2);
+    clear(ptr);
+    _root = merge(ptr1, ptr2);
+}
+
+template <typename __Tp, const __Tp Mod>
+void treap<__Tp, Mod>::reverse(size_t l, size_t r) {
+    Node *ptr, *ptr1, *ptr2;
+    ranksplit(_root, l - 1, ptr1, ptr);
+    ranksplit(ptr, r - l + 1, ptr, ptr2);
+    if (ptr != nullptr) ptr->revflag ^= 1;
+    _root = merge(ptr1, merge(ptr, ptr2));
+}
+
+template <typename __Tp, const __Tp Mod>
+void treap<__Tp, Mod>::split(size_t k, treap& other) {
+    if (&other == this) return;
+
+    Node *ptr1, *ptr2;
+    ranksplit(_root, k, ptr1, ptr2);
+    other.clear(other._root);
+    _root = ptr1;
+    other._root = ptr2;
+    other._pool = _pool;
+}
+
+template <typename __Tp, const __Tp Mod>
+void treap<__Tp, Mod>::concat(treap& other) {
+    if (&other == this) return;
+
+    _pool.unite(other._pool);
+
+    _root = merge(_root, other._root);
+    other._root = nullptr;
+}
+
 template <typename __Tp, const __Tp Mod>
 void treap<__Tp, Mod>::add_update(size_t l, size_t r, const __Tp v) {
     Node *ptr, *ptr1, *ptr2;
@@ -0,0 +1,914 @@
+/* Octinc includes library.
+ *
+ * Copyright (C) 2019-2019 Octinc Repositories, WeKw team.
+ *
+ * The source uses the GNU AFFERO GENERAL PUBLIC LICENSE Version 3,
+ * please follow the licence.
+ */
+#ifndef OCTINC_B_PLUS_TREE_HPP
+#  define OCTINC_B_PLUS_TREE_HPP
+#  ifndef STD_BITS_STDCPP_H
+#    define STD_BITS_STDCPP_H
+#    include <bits/stdc++.h>
+#  endif
+#  if defined(__AVX2__) || defined(__SSE2__)
+#    include <immintrin.h>
+#  endif
+
+namespace Octinc {
+namespace detail {
+template <typename __Key, typename __Cmp>
+struct __bplus_search
+/*
+In-node search of a B+-tree: how many of the n sorted keys are less than x,
+or not greater than x. Branch-free binary search; integer keys under
+std::less compare the whole node with SIMD instead (below).
+*/
+{
+    static int less(const __Key* k, int n, const __Key& x, const __Cmp& cmp) {
+        const __Key* base = k;
+
+        if (n == 0) return 0;
+
+        for (; n > 1; n -= n >> 1)
+            if (cmp(base[n >> 1], x)) base += n >> 1;
+
+        return base - k + cmp(*base, x);
+    }
+
+    static int not_greater(const __Key* k, int n, const __Key& x,
+                           const __Cmp& cmp) {
+        const __Key* base = k;
+
+        if (n == 0) return 0;
+
+        for (; n > 1; n -= n >> 1)
+            if (!cmp(x, base[n >> 1])) base += n >> 1;
+
+        return base - k + !cmp(x, *base);
+    }
+};
+
+#  if defined(__AVX2__) || defined(__SSE2__)
+template <size_t __Width>
+struct __bplus_simd;
+/*
+Masks of the lanes of a node where key > x (greater) or x > key (less), for
+signed integers of __Width bytes; the key arrays are padded to whole vectors.
+*/
+
+#    if defined(__AVX2__)
+template <>
+struct __bplus_simd<4> {
+    static const int lanes = 8;
+
+    static unsigned less(const void* k, const void* x) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)k);
+        __m256i v = _mm256_set1_epi32(*(const int*)x);
+        return _mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpgt_epi32(v, a)));
+    }
+
+    static unsigned greater(const void* k, const void* x) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)k);
+        __m256i v = _mm256_set1_epi32(*(const int*)x);
+        return _mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpgt_epi32(a, v)));
+    }
+};
+
+template <>
+struct __bplus_simd<8> {
+    static const int lanes = 4;
+
+    static unsigned less(const void* k, const void* x) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)k);
+        __m256i v = _mm256_set1_epi64x(*(const long long*)x);
+        return _mm256_movemask_pd(
+            _mm256_castsi256_pd(_mm256_cmpgt_epi64(v, a)));
+    }
+
+    static unsigned greater(const void* k, const void* x) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)k);
+        __m256i v = _mm256_set1_epi64x(*(const long long*)x);
+        return _mm256_movemask_pd(
+            _mm256_castsi256_pd(_mm256_cmpgt_epi64(a, v)));
+    }
+};
+#    else
+template <>
+struct __bplus_simd<4> {
+    static const int lanes = 4;
+
+    static unsigned less(const void* k, const void* x) {
+        __m128i a = _mm_loadu_si128((const __m128i*)k);
+        __m128i v = _mm_set1_epi32(*(const int*)x);
+        return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v, a)));
+    }
+
+    static unsigned greater(const void* k, const void* x) {
+        __m128i a = _mm_loadu_si128((const __m128i*)k);
+        __m128i v = _mm_set1_epi32(*(const int*)x);
+        return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(a, v)));
+    }
+};
+#    endif
+
+template <typename __Int>
+struct __bplus_simd_search {
+    typedef __bplus_simd<sizeof(__Int)> S;
+
+    template <typename __Cmp>
+    static int less(const __Int* k, int n, const __Int& x, const __Cmp&) {
+        int c = 0;
+
+        for (int i = 0; i < n; i += S::lanes) {
+            unsigned m = S::less(k + i, &x);
+
+            if (n - i < S::lanes) m &= (1u << (n - i)) - 1;
+
+            c += __builtin_popcount(m);
+        }
+
+        return c;
+    }
+
+    template <typename __Cmp>
+    static int not_greater(const __Int* k, int n, const __Int& x,
+                           const __Cmp&) {
+        int c = n;
+
+        for (int i = 0; i < n; i += S::lanes) {
+            unsigned m = S::greater(k + i, &x);
+
+            if (n - i < S::lanes) m &= (1u << (n - i)) - 1;
+
+            c -= __builtin_popcount(m);
+        }
+
+        return c;
+    }
+};
+
+template <>
+struct __bplus_search<int, std::less<int> > : __bplus_simd_search<int> {};
+
+#    if defined(__AVX2__)
+template <>
+struct __bplus_search<long long, std::less<long long> >
+    : __bplus_simd_search<long long> {};
+
+#      if __SIZEOF_LONG__ == 8
+template <>
+struct __bplus_search<long, std::less<long> > : __bplus_simd_search<long> {};
+#      endif
+#    endif
+#  endif
+
+struct __bplus_pair {
+    template <typename __Elem, typename __Key, typename __Value>
+    void operator()(const __Elem& e, __Key& k, __Value& v) const {
+        k = e.first, v = e.second;
+    }
+};
+
+struct __bplus_key {
+    template <typename __Elem, typename __Key, typename __Value>
+    void operator()(const __Elem& e, __Key& k, __Value&) const {
+        k = e;
+    }
+};
+
+struct __bplus_none {};
+}  // namespace detail
+
+template <typename __Key, typename __Value, typename __Cmp = std::less<__Key>,
+          size_t __Bytes = 256>
+class b_plus_tree
+/*
+B+-tree ordered map. The keys of a node are one cache-line aligned array of
+about __Bytes, scanned with SIMD for integer keys; the values live in the
+leaves, which are linked for range scans, and inner nodes keep the size of
+every subtree for get_kth/get_rank. Keys are unique.
+*/
+{
+   public:
+    enum {
+        Cap = sizeof(__Key) * 8 >= __Bytes ? 8 : (__Bytes / sizeof(__Key)) & ~7
+    };
+
+   private:
+    struct Node {
+        alignas(64) __Key keys[Cap];
+        int n;
+
+        Node() : keys(), n(0) {}
+    };
+
+    struct Leaf : Node {
+        __Value vals[Cap];
+        Leaf *prev, *next;
+
+        Leaf() : prev(nullptr), next(nullptr) {}
+    };
+
+    struct Inner : Node {
+        Node* child[Cap + 1];
+        size_t count[Cap + 1];
+    };
+    /*
+    keys[i] is a lower bound of the keys under child[i + 1] and above those
+    under child[i]; count[i] is the size of child[i].
+    */
+
+    typedef detail::__bplus_search<__Key, __Cmp> search;
+
+    Node* _root;
+    Leaf *_first, *_last;
+    int height;
+    size_t _size;
+    __Cmp _cmp;
+
+    static size_t weight(Node* p, int level) {
+        if (level == 0) return p->n;
+
+        size_t s = 0;
+        Inner* q = (Inner*)p;
+
+        for (int i = 0; i <= q->n; ++i) s += q->count[i];
+
+        return s;
+    }
+
+    bool insert(Node*, int, const __Key&, const __Value&, __Key&, Node*&);
+    bool remove(Node*, int, const __Key&);
+    void rebalance(Inner*, int, int);
+    void destroy(Node*, int);
+    Node* clone(Node*, int, Leaf*&);
+
+   public:
+    class iterator : public std::iterator<std::bidirectional_iterator_tag,
+                                          __Key> {
+       private:
+        friend class b_plus_tree;
+
+        Leaf* p;
+        int i;
+        const b_plus_tree* t;
+
+        iterator(Leaf* p, int i, const b_plus_tree* t) : p(p), i(i), t(t) {}
+
+       public:
+        iterator() : p(nullptr), i(0), t(nullptr) {}
+
+        const __Key& key() const { return p->keys[i]; }
+
+        __Value& value() const { return p->vals[i]; }
+
+        const __Key& operator*() const { return p->keys[i]; }
+
+        iterator& operator++() {
+            if (p && ++i == p->n) p = p->next, i = 0;
+
+            return *this;
+        }
+
+        iterator& operator--() {
+            if (!p) {
+                // end() of an empty tree stays end().
+                if (t->_size) p = t->_last, i = p->n - 1;
+            } else if (i == 0)
+                p = p->prev, i = p ? p->n - 1 : 0;
+            else
+                --i;
+
+            return *this;
+        }
+
+        iterator operator++(int) {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        iterator operator--(int) {
+            iterator old = *this;
+            --*this;
+            return old;
+        }
+
+        bool operator==(const iterator& other) const {
+            return p == other.p && i == other.i;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+    };
+
+    b_plus_tree() : _root(new Leaf), height(0), _size(0) {
+        _first = _last = (Leaf*)_root;
+    }
+
+    b_plus_tree(const b_plus_tree& other)
+        : height(other.height), _size(other._size), _cmp(other._cmp) {
+        Leaf* prev = nullptr;
+        _root = clone(other._root, height, prev);
+        _last = prev;
+    }
+
+    b_plus_tree& operator=(const b_plus_tree& other) {
+        if (this != &other) {
+            b_plus_tree copy(other);
+            swap(copy);
+        }
+
+        return *this;
+    }
+
+    ~b_plus_tree() { destroy(_root, height); }
+
+    void swap(b_plus_tree& other) {
+        std::swap(_root, other._root), std::swap(_first, other._first);
+        std::swap(_last, other._last), std::swap(height, other.height);
+        std::swap(_size, other._size), std::swap(_cmp, other._cmp);
+    }
+
+    bool insert(const __Key& key, const __Value& val);
+    /*
+    Insert the key with the value, or overwrite the value of a present key;
+    return whether the key is new.
+    */
+    bool remove(const __Key& key);
+    /*
+    Delete the key, return whether it was present.
+    */
+
+    template <typename _It, typename _Fill = detail::__bplus_pair>
+    void build(_It first, _It last, _Fill fill = _Fill());
+    /*
+    Replace the contents with the strictly increasing range [first, last) in
+    O(n), packing the nodes full. fill(*it, key, value) unpacks an element,
+    by default a std::pair.
+    */
+
+    iterator find(const __Key& key) const;
+    iterator lower_bound(const __Key& key) const;
+    /*
+    The first key not less than the key.
+    */
+    iterator upper_bound(const __Key& key) const;
+    /*
+    The first key greater than the key.
+    */
+    iterator get_kth(size_t k) const;
+    /*
+    Query the kth key (from 1), or end().
+    */
+    size_t get_rank(const __Key& key) const;
+    /*
+    Query the rank of the key: one more than the number of smaller keys.
+    */
+
+    template <typename _Func>
+    void range(const __Key& lo, const __Key& hi, _Func f) const
+    /*
+    Call f(key, value) in order for every key in [lo, hi), walking the
+    linked leaves.
+    */
+    {
+        iterator it = lower_bound(lo);
+
+        for (Leaf* p = it.p; p; p = p->next)
+            for (int i = p == it.p ? it.i : 0; i < p->n; ++i)
+                if (_cmp(p->keys[i], hi))
+                    f(p->keys[i], p->vals[i]);
+                else
+                    return;
+    }
+
+    bool count(const __Key& key) const { return find(key) != end(); }
+
+    __Value& operator[](const __Key& key) {
+        iterator it = find(key);
+
+        if (it != end()) return it.value();
+
+        insert(key, __Value());
+        return find(key).value();
+    }
+
+    size_t size() const { return _size; }
+
+    bool empty() const { return _size == 0; }
+
+    iterator begin() const {
+        return _size ? iterator(_first, 0, this) : end();
+    }
+
+    iterator end() const { return iterator(nullptr, 0, this); }
+
+    void clear() {
+        destroy(_root, height);
+        _root = _first = _last = new Leaf;
+        height = 0, _size = 0;
+    }
+};
+
+template <typename __Key, typename __Value, typename __Cmp, size_t __Bytes>
+bool b_plus_tree<__Key, __Value, __Cmp, __Bytes>::insert(const __Key& key,
+                                                         const __Value& val) {
+    __Key sep;
+    Node* right = nullptr;
+
+    if (!insert(_root, height, key, val, sep, right)) return false;
+
+    ++_size;
+
+    if (right) {
+        Inner* root = new Inner;
+        root->n = 1, root->keys[0] = sep;
+        root->child[0] = _root, root->child[1] = right;
+        root->count[0] = weight(_root, height);
+        root->count[1] = weight(right, height);
+        _root = root, ++height;
+    }
+
+    return true;
+}
+
+template <typename __Key, typename __Value, typename __Cmp, size_t __Bytes>
+bool b_plus_tree<__Key, __Value, __Cmp, __Bytes>::insert(
+    Node* p, int level, const __Key& key, const __Value& val, __Key& sep,
+    Node*& right) {
+    right = nullptr;
+
+    if (level == 0) {
+        Leaf* q = (Leaf*)p;
+        int pos = search::less(q->keys, q->n, key, _cmp);
+
+        if (pos < q->n && !_cmp(key, q->keys[pos])) {
+            q->vals[pos] = val;
+            return false;
+        }
+
+        if (q->n == Cap) {
+            // Split in half; the new key goes to the half that covers it.
+            Leaf* r = new Leaf;
+            int half = Cap / 2;
+
+            std::move(q->keys + half, q->keys + Cap, r->keys);
+            std::move(q->vals + half, q->vals + Cap, r->vals);
+            r->n = Cap - half, q->n = half;
+            r->next = q->next, r->prev = q;
+            (q->next ? q->next->prev : _last) = r;
+            q->next = r;
+            right = r;
+
+            if (pos > half) q = r, pos -= half;
+        }
+
+        std::move_backward(q->keys + pos, q->keys + q->n, q->keys + q->n + 1);
+        std::move_backward(q->vals + pos, q->vals + q->n, q->vals + q->n + 1);
+        q->keys[pos] = key, q->vals[pos] = val, ++q->n;
+
+        if (right) sep = ((Leaf*)right)->keys[0];
+
+        return true;
+    }
+
+    Inner* q = (Inner*)p;
+    int i = search::not_greater(q->keys, q->n, key, _cmp);
+    __Key up;
+    Node* split = nullptr;
+
+    if (!insert(q->child[i], level - 1, key, val, up, split)) return false;
+
+    ++q->count[i];
+
+    if (!split) return true;
+
+    size_t moved = weight(split, level - 1);
+    q->count[i] -= moved;
+
+    if (q->n == Cap) {
+        // The middle separator moves up, the upper half to a new node.
+        Inner* r = new Inner;
+        int half = Cap / 2;
+
+        std::move(q->keys + half + 1, q->keys + Cap, r->keys);
+        std::copy(q->child + half + 1, q->child + Cap + 1, r->child);
+        std::copy(q->count + half + 1, q->count + Cap + 1, r->count);
+        r->n = Cap - half - 1, q->n = half;
+        sep = q->keys[half];
+        right = r;
+
+        if (i > half) q = r, i -= half + 1;
+    }
+
+    std::move_backward(q->keys + i, q->keys + q->n, q->keys + q->n + 1);
+    std::copy_backward(q->child + i + 1, q->child + q->n + 1,
+                       q->child + q->n + 2);
+    std::copy_backward(q->count + i + 1, q->count + q->n + 1,
+                       q->count + q->n + 2);
+    q->keys[i] = up, q->child[i + 1] = split, q->count[i + 1] = moved;
+    ++q->n;
+
+    return true;
+}
+
+template <typename __Key, typename __Value, typename __Cmp, size_t __Bytes>
+bool b_plus_tree<__Key, __Value, __Cmp, __Bytes>::remove(const __Key& key) {
+    if (!remove(_root, height, key)) return false;
+
+    --_size;
+
+    if (height && _root->n == 0) {
+        Node* old = _root;
+        _root = ((Inner*)old)->child[0], --height;
+        delete (Inner*)old;
+    }
+
+    return true;
+}
+
+template <typename __Key, typename __Value, typename __Cmp, size_t __Bytes>
+bool b_plus_tree<__Key, __Value, __Cmp, __Bytes>::remove(Node* p, int level,
+                                                         const __Key& key) {
+    if (level == 0) {
+        Leaf* q = (Leaf*)p;
+        int pos = search::less(q->keys, q->n, key, _cmp);
+
+        if (pos == q->n || _cmp(key, q->keys[pos])) return false;
+
+        std::move(q->keys + pos + 1, q->keys + q->n, q->keys + pos);
+        std::move(q->vals + pos + 1, q->vals + q->n, q->vals + pos);
+        --q->n;
+
+        return true;
+    }
+
+    Inner* q = (Inner*)p;
+    int i = search::not_greater(q->keys, q->n, key, _cmp);
+
+    if (!remove(q->child[i], level - 1, key)) return false;
+
+    --q->count[i];
+
+    if (q->child[i]->n < Cap / 2) rebalance(q, i, level - 1);
+
+    return true;
+}
+
+template <typename __Key, typename __Value, typename __Cmp, size_t __Bytes>
+void b_plus_tree<__Key, __Value, __Cmp, __Bytes>::rebalance(Inner* p, int i,
+                                                            int level)
+/*
+child[i] of p, at the given level, is under half full: borrow one entry from
+a sibling that can spare it, otherwise merge with a sibling.
+*/
+{
+    const int low = Cap / 2;
+
+    if (i > 0 && p->child[i - 1]->n > low) {
+        Node *l = p->child[i - 1], *c = p->child[i];
+        size_t moved = 1;
+
+        std::move_backward(c->keys, c->keys + c->n, c->keys + c->n + 1);
+
+        if (level == 0) {
+            Leaf *a = (Leaf*)l, *b = (Leaf*)c;
+            std::move_backward(b->vals, b->vals + b->n, b->vals + b->n + 1);
+            b->keys[0] = a->keys[a->n - 1], b->vals[0] = a->vals[a->n - 1];
+            p->keys[i - 1] = b->keys[0];
+        } else {
+            Inner *a = (Inner*)l, *b = (Inner*)c;
+            std::copy_backward(b->child, b->child + b->n + 1,
+                               b->child + b->n + 2);
+            std::copy_backward(b->count, b->count + b->n + 1,
+                               b->count + b->n + 2);
+            b->keys[0] = p->keys[i - 1];
+            b->child[0] = a->child[a->n], b->count[0] = a->count[a->n];
+            p->keys[i - 1] = a->keys[a->n - 1];
+            moved = b->count[0];
+        }
+
+        --l->n, ++c->n;
+        p->count[i - 1] -= moved, p->count[i] += moved;
+        return;
+    }
+
+    if (i < p->n && p->child[i + 1]->n > low) {
+        Node *c = p->child[i], *r = p->child[i + 1];
+        size_t moved = 1;
+
+        if (level == 0) {
+            Leaf *a = (Leaf*)c, *b = (Leaf*)r;
+            a->keys[a->n] = b->keys[0], a->vals[a->n] = b->vals[0];
+            std::move(b->keys + 1, b->keys + b->n, b->keys);
+            std::move(b->vals + 1, b->vals + b->n, b->vals);
+            p->keys[i] = b->keys[0];
+        } else {
+            Inner *a = (Inner*)c, *b = (Inner*)r;
+            a->keys[a->n] = p->keys[i];
+            a->child[a->n + 1] = b->child[0], a->count[a->n + 1] = b->count[0];
+            p->keys[i] = b->keys[0];
+            moved = b->count[0];
+            std::move(b->keys + 1, b->keys + b->n, b->keys);
+            std::copy(b->child + 1, b->child + b->n + 1, b->child);
+            std::copy(b->count + 1, b->count + b->n + 1, b->count);
+        }
+
+        ++c->n, --r->n;
+        p->count[i] += moved, p->count[i + 1] -= moved;
+        return;
+    }
+
+    // Merge child[j + 1] into child[j]; both are at most half full.
+    int j = i > 0 ? i - 1 : i;
+    Node *l = p->child[j], *r = p->child[j + 1];
+
+    if (level == 0) {
+        Leaf *a = (Leaf*)l, *b = (Leaf*)r;
+        std::move(b->keys, b->keys + b->n, a->keys + a->n);
+        std::move(b->vals, b->vals + b->n, a->vals + a->n);
+        a->n += b->n;
+        a->next = b->next;
+        (b->next ? b->next->prev : _last) = a;
+        delete b;
+    } else {
+        Inner *a = (Inner*)l, *b = (Inner*)r;
+        a->keys[a->n] = p->keys[j];
+        std::move(b->keys, b->keys + b->n, a->keys + a->n + 1);
+        std::copy(b->child, b->child + b->n + 1, a->child + a->n + 1);
+        std::copy(b->count, b->count + b->n + 1, a->count + a->n + 1);
+        a->n += b->n + 1;
+        delete b;
+    }
+
+    p->count[j] += p->count[j + 1];
+    std::move(p->keys + j + 1, p->keys + p->n, p->keys + j);
+    std::copy(p->child + j + 2, p->child + p->n + 1, p->child + j + 1);
+    std::copy(p->count + j + 2, p->count + p->n + 1, p->count + j + 1);
+    --p->n;
+}
+
+template <typename __Key, typename __Value, typename __Cmp, size_t __Bytes>
+template <typename _It, typename _Fill>
+void b_plus_tree<__Key, __Value, __Cmp, __Bytes>::build(_It first, _It last,
+                                                        _Fill fill) {
+    std::vector<Node*> level;
+    std::vector<__Key> low;
+    std::vector<size_t> size;
+    size_t n = std::distance(first, last);
+
+    destroy(_root, height);
+    height = 0, _size = n;
+
+    // Spread the n keys evenly over as few full nodes as possible.
+    size_t nodes = std::max<size_t>(1, (n + Cap - 1) / Cap);
+    Leaf* prev = nullptr;
+
+    for (size_t k = 0; k < nodes; ++k) {
+        Leaf* q = new Leaf;
+        q->n = n * (k + 1) / nodes - n * k / nodes;
+
+        for (int i = 0; i < q->n; ++i, ++first)
+            fill(*first, q->keys[i], q->vals[i]);
+
+        q->prev = prev;
+        (prev ? prev->next : _first) = q;
+        prev = q;
+        level.push_back(q), size.push_back(q->n);
+        low.push_back(q->n ? q->keys[0] : __Key());
+    }
+
+    _last = prev;
+
+    while (level.size() > 1) {
+        size_t m = level.size(), groups = (m + Cap) / (Cap + 1);
+        std::vector<Node*> up;
+        std::vector<__Key> up_low;
+        std::vector<size_t> up_size;
+
+        for (size_t g = 0, at = 0; g < groups; ++g) {
+            Inner* q = new Inner;
+            size_t take = m * (g + 1) / groups - m * g / groups, total = 0;
+
+            for (size_t c = 0; c < take; ++c, ++at) {
+                q->child[c] = level[at], q->count[c] = size[at];
+                total += size[at];
+
+                if (c) q->keys[c - 1] = low[at];
+            }
+
+            q->n = take - 1;
+            up.push_back(q), up_low.push_back(low[at - take]);
+            up_size.push_back(total);
+        }
+
+        level.swap(up), low.swap(up_low), size.swap(up_size);
+        ++height;
+    }
+
+    _root = level[0];
+}
+
+template <typename __Key, typename __Value, typename __Cmp, size_t __Bytes>
+typename b_plus_tree<__Key, __Value, __Cmp, __Bytes>::iterator
+b_plus_tree<__Key, __Value, __Cmp, __Bytes>::lower_bound(
+    const __Key& key) const {
+    Node* p = _root;
+
+    for (int level = height; level > 0; --level) {
+        Inner* q = (Inner*)p;
+        p = q->child[search::not_greater(q->keys, q->n, key, _cmp)];
+    }
+
+    Leaf* q = (Leaf*)p;
+    int pos = search::less(q->keys, q->n, key, _cmp);
+
+    if (pos == q->n) return iterator(q->next, 0, this);
+
+    return iterator(q, pos, this);
+}
+
+template <typename __Key, typename __Value, typename __Cmp, size_t __Bytes>
+typename b_plus_tree<__Key, __Value, __Cmp, __Bytes>::iterator
+b_plus_tree<__Key, __Value, __Cmp, __Bytes>::upper_bound(
+    const __Key& key) const {
+    Node* p = _root;
+
+    for (int level = height; level > 0; --level) {
+        Inner* q = (Inner*)p;
+        p = q->child[search::not_greater(q->keys, q->n, key, _cmp)];
+    }
+
+    Leaf* q = (Leaf*)p;
+    int pos = search::not_greater(q->keys, q->n, key, _cmp);
+
+    if (pos == q->n) return iterator(q->next, 0, this);
+
+    return iterator(q, pos, this);
+}
+
+template <typename __Key, typename __Value, typename __Cmp, size_t __Bytes>
+typename b_plus_tree<__Key, __Value, __Cmp, __Bytes>::iterator
+b_plus_tree<__Key, __Value, __Cmp, __Bytes>::find(const __Key& key) const {
+    iterator it = lower_bound(key);
+
+    if (it.p && !_cmp(key, it.key())) return it;
+
+    return end();
+}
+
+template <typename __Key, typename __Value, typename __Cmp, size_t __Bytes>
+typename b_plus_tree<__Key, __Value, __Cmp, __Bytes>::iterator
+b_plus_tree<__Key, __Value, __Cmp, __Bytes>::get_kth(size_t k) const {
+    if (k < 1 || k > _size) return end();
+
+    Node* p = _root;
+
+    for (int level = height; level > 0; --level) {
+        Inner* q = (Inner*)p;
+        int i = 0;
+
+        while (k > q->count[i]) k -= q->count[i++];
+
+        p = q->child[i];
+    }
+
+    return iterator((Leaf*)p, k - 1, this);
+}
+
+template <typename __Key, typename __Value, typename __Cmp, size_t __Bytes>
+size_t b_plus_tree<__Key, __Value, __Cmp, __Bytes>::get_rank(
+    const __Key& key) const {
+    Node* p = _root;
+    size_t rank = 1;
+
+    for (int level = height; level > 0; --level) {
+        Inner* q = (Inner*)p;
+        int i = search::not_greater(q->keys, q->n, key, _cmp);
+
+        for (int j = 0; j < i; ++j) rank += q->count[j];
+
+        p = q->child[i];
+    }
+
+    return rank + search::less(p->keys, p->n, key, _cmp);
+}
+
+template <typename __Key, typename __Value, typename __Cmp, size_t __Bytes>
+void b_plus_tree<__Key, __Value, __Cmp, __Bytes>::destroy(Node* p, int level) {
+    if (level == 0) {
+        delete (Leaf*)p;
+        return;
+    }
+
+    Inner* q = (Inner*)p;
+
+    for (int i = 0; i <= q->n; ++i) destroy(q->child[i], level - 1);
+
+    delete q;
+}
+
+template <typename __Key, typename __Value, typename __Cmp, size_t __Bytes>
+typename b_plus_tree<__Key, __Value, __Cmp, __Bytes>::Node*
+b_plus_tree<__Key, __Value, __Cmp, __Bytes>::clone(Node* p, int level,
+                                                   Leaf*& prev) {
+    if (level == 0) {
+        Leaf* q = new Leaf(*(Leaf*)p);
+        q->prev = prev, q->next = nullptr;
+        (prev ? prev->next : _first) = q;
+        prev = q;
+        return q;
+    }
+
+    Inner* q = new Inner(*(Inner*)p);
+
+    for (int i = 0; i <= q->n; ++i)
+        q->child[i] = clone(q->child[i], level - 1, prev);
+
+    return q;
+}
+
+template <typename __Key, typename __Cmp = std::less<__Key>,
+          size_t __Bytes = 256>
+class b_plus_set
+/*
+B+-tree ordered set, see b_plus_tree.
+*/
+{
+   private:
+    typedef b_plus_tree<__Key, detail::__bplus_none, __Cmp, __Bytes> tree_type;
+
+    tree_type tree;
+
+   public:
+    typedef typename tree_type::iterator iterator;
+
+    bool insert(const __Key& key)
+    /*
+    Insert a key, return whether it is new.
+    */
+    {
+        return tree.insert(key, detail::__bplus_none());
+    }
+
+    bool remove(const __Key& key)
+    /*
+    Delete the key, return whether it was present.
+    */
+    {
+        return tree.remove(key);
+    }
+
+    template <typename _It>
+    void build(_It first, _It last)
+    /*
+    Replace the contents with the strictly increasing keys in [first, last).
+    */
+    {
+        tree.build(first, last, detail::__bplus_key());
+    }
+
+    iterator find(const __Key& key) const { return tree.find(key); }
+
+    iterator lower_bound(const __Key& key) const {
+        return tree.lower_bound(key);
+    }
+
+    iterator upper_bound(const __Key& key) const {
+        return tree.upper_bound(key);
+    }
+
+    iterator get_kth(size_t k) const { return tree.get_kth(k); }
+
+    size_t get_rank(const __Key& key) const { return tree.get_rank(key); }
+
+    template <typename _Func>
+    void range(const __Key& lo, const __Key& hi, _Func f) const
+    /*
+    Call f(key) in order for every key in [lo, hi).
+    */
+    {
+        tree.range(lo, hi,
+                   [&](const __Key& k, const detail::__bplus_none&) { f(k); });
+    }
+
+    bool count(const __Key& key) const { return tree.count(key); }
+
+    size_t size() const { return tree.size(); }
+
+    bool empty() const { return tree.empty(); }
+
+    iterator begin() const { return tree.begin(); }
+
+    iterator end() const { return tree.end(); }
+
+    void clear() { tree.clear(); }
+};
+}  // namespace Octinc
+
+#endif
@@ -11,76 +11,684 @@
 #    define STD_BITS_STDCPP_H
 #    include <bits/stdc++.h>
 #  endif
+#  if defined(__AVX2__) || defined(__SSE2__)
+#    include <immintrin.h>
+#  endif
+#  include "../Junior/sequence.hpp"
 
 namespace Octinc {
 namespace detail {
-void __suffix_array_radix(std::string str, int *a, int *b, int m) {
-    int n = str.size();
-    int *count = new int[2 * m + 1];
-    memset(count, 0, (2 * m + 1) * sizeof(int));
+template <typename __Tp>
+struct __identity {
+    typedef __Tp type;
+};
+
+template <typename __Tp>
+using __nondeduced = typename __identity<__Tp>::type;
+/*
+Keeps a parameter out of template argument deduction.
+*/
+
+template <typename __Tp, typename __Idx>
+struct __sais_text
+/*
+Input of the first SA-IS level with a virtual, unique smallest sentinel
+appended, so the text itself is never copied.
+*/
+{
+    const __Tp *p;
+    __Idx n;
+
+    __Idx operator[](__Idx i) const { return i == n ? 0 : __Idx(p[i]) + 1; }
+};
+
+template <typename __Idx, typename __Str>
+void __sais_buckets(const __Str &s, std::vector<__Idx> &bkt, __Idx n,
+                    bool end) {
+    __Idx sum = 0;
+    std::fill(bkt.begin(), bkt.end(), 0);
+
+    for (__Idx i = 0; i < n; ++i) ++bkt[s[i]];
+
+    for (size_t i = 0; i < bkt.size(); ++i) {
+        sum += bkt[i];
+        bkt[i] = end ? sum : sum - bkt[i];
+    }
+}
+
+template <typename __Idx, typename __Str>
+void __sais_induce(const __Str &s, const std::vector<bool> &t, __Idx *SA,
+                   std::vector<__Idx> &bkt, __Idx n) {
+    __sais_buckets(s, bkt, n, false);
+
+    for (__Idx i = 0; i < n; ++i) {
+        __Idx j = SA[i] - 1;
+
+        if (j >= 0 && !t[j]) SA[bkt[s[j]]++] = j;
+    }
+
+    __sais_buckets(s, bkt, n, true);
+
+    for (__Idx i = n - 1; i >= 0; --i) {
+        __Idx j = SA[i] - 1;
+
+        if (j >= 0 && t[j]) SA[--bkt[s[j]]] = j;
+    }
+}
+
+template <typename __Idx, typename __Str>
+void __sais(const __Str &s, __Idx *SA, __Idx n, __Idx K)
+/*
+SA-IS (Nong, Zhang and Chan). s[n - 1] has to be the unique smallest
+symbol and every symbol lies in [0, K]. The reduced problem is solved
+inside SA, so the extra memory is n bits plus K + 1 buckets per level.
+*/
+{
+    std::vector<bool> t(n, false);
+    std::vector<__Idx> bkt(K + 1);
+    auto lms = [&](__Idx i) { return i > 0 && t[i] && !t[i - 1]; };
+
+    t[n - 1] = true;
+
+    for (__Idx i = n - 2; i >= 0; --i)
+        t[i] = s[i] < s[i + 1] || (s[i] == s[i + 1] && t[i + 1]);
+
+    __sais_buckets(s, bkt, n, true);
+    std::fill(SA, SA + n, -1);
+
+    for (__Idx i = 1; i < n; ++i)
+        if (lms(i)) SA[--bkt[s[i]]] = i;
+
+    __sais_induce(s, t, SA, bkt, n);
+
+    __Idx n1 = 0, name = 0, prev = -1;
+
+    for (__Idx i = 0; i < n; ++i)
+        if (lms(SA[i])) SA[n1++] = SA[i];
+
+    std::fill(SA + n1, SA + n, -1);
+
+    for (__Idx i = 0; i < n1; ++i) {
+        __Idx pos = SA[i];
+        bool diff = false;
+
+        for (__Idx d = 0; d < n; ++d)
+            if (prev == -1 || s[pos + d] != s[prev + d] ||
+                t[pos + d] != t[prev + d]) {
+                diff = true;
+                break;
+            } else if (d > 0 && (lms(pos + d) || lms(prev + d)))
+                break;
+
+        if (diff) ++name, prev = pos;
+
+        SA[n1 + pos / 2] = name - 1;
+    }
+
+    for (__Idx i = n - 1, j = n - 1; i >= n1; --i)
+        if (SA[i] >= 0) SA[j--] = SA[i];
+
+    __Idx *SA1 = SA, *s1 = SA + n - n1;
+
+    if (name < n1)
+        __sais<__Idx, const __Idx *>(s1, SA1, n1, name - 1);
+    else
+        for (__Idx i = 0; i < n1; ++i) SA1[s1[i]] = i;
+
+    for (__Idx i = 1, j = 0; i < n; ++i)
+        if (lms(i)) s1[j++] = i;
+
+    for (__Idx i = 0; i < n1; ++i) SA1[i] = s1[SA1[i]];
+
+    std::fill(SA + n1, SA + n, -1);
+    __sais_buckets(s, bkt, n, true);
+
+    for (__Idx i = n1 - 1; i >= 0; --i) {
+        __Idx j = SA[i];
+        SA[i] = -1;
+        SA[--bkt[s[j]]] = j;
+    }
+
+    __sais_induce(s, t, SA, bkt, n);
+}
+
+template <typename __Tp, typename __Idx>
+bool __suffix_array_sais(const __Tp *str, size_t n, __Idx K,
+                         std::vector<__Idx> &sa, std::vector<__Idx> *lcp,
+                         size_t memory_budget) {
+    if (n >= (size_t)std::numeric_limits<__Idx>::max() / 2) return false;
+
+    // Scratch beyond the text and the outputs: type bits and buckets of
+    // every level, the reduced alphabet, and the PLCP array.
+    size_t scratch = n / 4 + (size_t(K) + 2 + n / 2) * sizeof(__Idx) +
+                     (lcp ? n * sizeof(__Idx) : 0);
+
+    if (memory_budget && scratch > memory_budget) return false;
+
+    __Idx N = n;
+    sa.assign(n + 1, 0);
+    __sais(__sais_text<__Tp, __Idx>{str, N}, sa.data(), N + 1, K + 1);
+    sa.erase(sa.begin());
+
+    if (!lcp) return true;
+
+    // Kasai's algorithm in the permuted (PLCP) order of Karkkainen et al.
+    std::vector<__Idx> plcp(n);
+    lcp->assign(n, 0);
+
+    if (n) plcp[sa[0]] = -1;
+
+    for (size_t i = 1; i < n; ++i) plcp[sa[i]] = sa[i - 1];
+
+    for (__Idx i = 0, l = 0; i < N; ++i) {
+        __Idx j = plcp[i];
+
+        if (j < 0) {
+            plcp[i] = l = 0;
+            continue;
+        }
+
+        while (i + l < N && j + l < N && str[i + l] == str[j + l]) ++l;
+
+        plcp[i] = l;
+        l = std::max<__Idx>(l - 1, 0);
+    }
+
+    for (size_t i = 0; i < n; ++i) (*lcp)[i] = plcp[sa[i]];
+
+    return true;
+}
+
+class __rank_bitvector
+/*
+Bit vector with constant-time rank: one 64-bit count per 512 bits.
+*/
+{
+   private:
+    std::vector<uint64_t> bits, block;
+
+   public:
+    void assign(size_t n) { bits.assign((n >> 6) + 1, 0), block.clear(); }
+
+    void set(size_t i) { bits[i >> 6] |= 1ULL << (i & 63); }
+
+    bool operator[](size_t i) const { return bits[i >> 6] >> (i & 63) & 1; }
+
+    void build() {
+        uint64_t sum = 0;
+        block.clear();
+
+        for (size_t i = 0; i < bits.size(); ++i) {
+            if (!(i & 7)) block.push_back(sum);
+
+            sum += __builtin_popcountll(bits[i]);
+        }
+    }
+
+    size_t rank1(size_t i) const
+    /*
+    Number of ones in [0, i).
+    */
+    {
+        size_t w = i >> 6, r = block[w >> 3];
+
+        for (size_t k = w & ~size_t(7); k < w; ++k)
+            r += __builtin_popcountll(bits[k]);
+
+        if (i & 63) r += __builtin_popcountll(bits[w] << (64 - (i & 63)));
+
+        return r;
+    }
+
+    size_t rank0(size_t i) const { return i - rank1(i); }
+
+    size_t bytes() const {
+        return (bits.size() + block.size()) * sizeof(uint64_t);
+    }
+};
+
+class __wavelet_matrix
+/*
+Wavelet matrix over bytes, rank and access in 8 bit-vector ranks.
+*/
+{
+   private:
+    __rank_bitvector level[8];
+    size_t zeros[8];
+
+   public:
+    void build(std::vector<unsigned char> v) {
+        size_t n = v.size();
+        std::vector<unsigned char> tmp(n);
+
+        for (int l = 0; l < 8; ++l) {
+            int b = 7 - l;
+            size_t z = 0;
+            level[l].assign(n);
+
+            for (size_t i = 0; i < n; ++i)
+                if (v[i] >> b & 1)
+                    level[l].set(i);
+                else
+                    ++z;
+
+            level[l].build(), zeros[l] = z;
+
+            for (size_t i = 0, lo = 0, hi = z; i < n; ++i)
+                (v[i] >> b & 1 ? tmp[hi++] : tmp[lo++]) = v[i];
+
+            v.swap(tmp);
+        }
+    }
+
+    size_t rank(unsigned char c, size_t i) const
+    /*
+    Occurrences of c in [0, i).
+    */
+    {
+        size_t p = 0;
+
+        for (int l = 0; l < 8; ++l)
+            if (c >> (7 - l) & 1)
+                p = zeros[l] + level[l].rank1(p),
+                i = zeros[l] + level[l].rank1(i);
+            else
+                p = level[l].rank0(p), i = level[l].rank0(i);
 
-    for (int i = 0; i < n; ++i) ++count[str[a[i]]];
+        return i - p;
+    }
+
+    unsigned char access(size_t i) const {
+        unsigned char c = 0;
+
+        for (int l = 0; l < 8; ++l)
+            if (level[l][i])
+                c = c << 1 | 1, i = zeros[l] + level[l].rank1(i);
+            else
+                c = c << 1, i = level[l].rank0(i);
+
+        return c;
+    }
+
+    size_t bytes() const {
+        size_t r = 0;
+
+        for (int l = 0; l < 8; ++l) r += level[l].bytes();
+
+        return r;
+    }
+};
+
+#  if defined(__AVX2__)
+struct __byte_simd {
+    static const size_t width = 32;
+    typedef __m256i vec;
+
+    static vec set1(char c) { return _mm256_set1_epi8(c); }
+
+    static unsigned eq2(const char *a, vec va, const char *b, vec vb) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)a);
+        __m256i y = _mm256_loadu_si256((const __m256i *)b);
+        return _mm256_movemask_epi8(_mm256_and_si256(
+            _mm256_cmpeq_epi8(x, va), _mm256_cmpeq_epi8(y, vb)));
+    }
+};
+#  elif defined(__SSE2__)
+struct __byte_simd {
+    static const size_t width = 16;
+    typedef __m128i vec;
+
+    static vec set1(char c) { return _mm_set1_epi8(c); }
+
+    static unsigned eq2(const char *a, vec va, const char *b, vec vb) {
+        __m128i x = _mm_loadu_si128((const __m128i *)a);
+        __m128i y = _mm_loadu_si128((const __m128i *)b);
+        return _mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(x, va), _mm_cmpeq_epi8(y, vb)));
+    }
+};
+#  endif
+
+class __two_way
+/*
+Crochemore-Perrin Two-Way search: O(n + m) time, O(1) extra space.
+*/
+{
+   private:
+    const unsigned char *p;
+    ptrdiff_t m, ms, per;
+    bool periodic;
+
+    static ptrdiff_t max_suffix(const unsigned char *x, ptrdiff_t m,
+                                ptrdiff_t &per, bool greater) {
+        ptrdiff_t i = -1, j = 0, k = 1;
+        per = 1;
+
+        while (j + k < m) {
+            unsigned char a = x[i + k], b = x[j + k];
+
+            if (a == b) {
+                if (k == per)
+                    j += per, k = 1;
+                else
+                    ++k;
+            } else if (greater ? a > b : a < b)
+                j += k, k = 1, per = j - i;
+            else
+                i = j++, k = per = 1;
+        }
+
+        return i;
+    }
+
+   public:
+    __two_way() : p(nullptr), m(0), ms(-1), per(1), periodic(false) {}
+
+    __two_way(const char *pattern, size_t len)
+        : p((const unsigned char *)pattern), m(len) {
+        ptrdiff_t p0, p1;
+        ms = max_suffix(p, m, p0, true);
+        ptrdiff_t ms1 = max_suffix(p, m, p1, false);
+
+        if (ms1 > ms)
+            ms = ms1, per = p1;
+        else
+            per = p0;
+
+        periodic = m && memcmp(p, p + per, ms + 1) == 0;
+
+        if (!periodic) per = std::max(ms + 1, m - ms - 1) + 1;
+    }
+
+    size_t shift() const
+    /*
+    How far to move past an occurrence without missing the next one; the
+    period of the pattern when it is periodic.
+    */
+    {
+        return per;
+    }
+
+    bool is_periodic() const
+    /*
+    Whether the pattern is periodic, so that shift() is its period.
+    */
+    {
+        return periodic;
+    }
+
+    size_t find(const char *text, size_t n, size_t from) const
+    /*
+    First occurrence in text[from, n), or std::string::npos.
+    */
+    {
+        const unsigned char *h = (const unsigned char *)text;
+        ptrdiff_t pos = from, mem = 0, last = (ptrdiff_t)n - m;
+
+        while (pos <= last) {
+            ptrdiff_t k = std::max(ms + 1, mem);
+
+            while (k < m && p[k] == h[pos + k]) ++k;
+
+            if (k < m) {
+                pos += k - ms, mem = 0;
+                continue;
+            }
+
+            for (k = ms + 1; k > mem && p[k - 1] == h[pos + k - 1];) --k;
+
+            if (k <= mem) return pos;
+
+            pos += per, mem = periodic ? m - per : 0;
+        }
+
+        return std::string::npos;
+    }
+};
+
+inline size_t __find_bytes(const char *text, size_t n, const char *pattern,
+                           size_t m, size_t from, const __two_way &fallback)
+/*
+First occurrence of the pattern in text[from, n). Candidates come from a
+SIMD compare of the first and last pattern bytes; once verifying them costs
+more than the bytes skipped, the rest of the text goes to Two-Way.
+*/
+{
+    if (m == 0) return from <= n ? from : std::string::npos;
+
+    if (from > n || n - from < m) return std::string::npos;
+
+    if (m == 1) {
+        const void *r = memchr(text + from, pattern[0], n - from);
+        return r ? (const char *)r - text : std::string::npos;
+    }
+
+    size_t i = from;
+
+#  if defined(__AVX2__) || defined(__SSE2__)
+    typedef __byte_simd S;
+    const size_t W = S::width;
+    S::vec first = S::set1(pattern[0]), last = S::set1(pattern[m - 1]);
+    size_t work = 0, found = std::string::npos;
+
+    auto verify = [&](unsigned mask, size_t base) {
+        for (; mask; mask &= mask - 1, work += m) {
+            size_t j = base + __builtin_ctz(mask);
+
+            if (memcmp(text + j + 1, pattern + 1, m - 2) == 0) return j;
+        }
+
+        return std::string::npos;
+    };
+
+    // Two vectors per round, the verification cost is checked after hits.
+    for (; i + m - 1 + 2 * W <= n; i += 2 * W) {
+        unsigned a = S::eq2(text + i, first, text + i + m - 1, last);
+        unsigned b = S::eq2(text + i + W, first, text + i + m - 1 + W, last);
+
+        if (!(a | b)) continue;
 
-    for (int i = 1; i <= m; ++i) count[i] += count[i - 1];
+        if ((found = verify(a, i)) != std::string::npos ||
+            (found = verify(b, i + W)) != std::string::npos)
+            return found;
 
-    for (int i = n - 1; i >= 0; --i) b[--count[str[a[i]]]] = a[i];
+        if (work > 2 * (i - from) + 4096) return fallback.find(text, n, i);
+    }
+
+    for (; i + m - 1 + W <= n; i += W)
+        if ((found = verify(S::eq2(text + i, first, text + i + m - 1, last),
+                            i)) != std::string::npos)
+            return found;
+#  endif
 
-    delete[] count;
+    return fallback.find(text, n, i);
 }
 
-void __suffix_array_radix(int *str, int *a, int *b, int n, int m) {
-    int *count = new int[2 * m + 1];
-    memset(count, 0, (2 * m + 1) * sizeof(int));
+inline unsigned long long __mersenne_mul(unsigned long long a,
+                                         unsigned long long b)
+/*
+a * b mod 2^61-1, for a, b below the modulus.
+*/
+{
+    const unsigned long long M = (1ull << 61) - 1;
+    unsigned __int128 c = (unsigned __int128)a * b;
+    unsigned long long r = (unsigned long long)(c & M) +
+                           (unsigned long long)(c >> 61);
+    return r >= M ? r - M : r;
+}
 
-    for (int i = 0; i < n; ++i) ++count[str[a[i]]];
+inline unsigned long long __mersenne_add(unsigned long long a,
+                                         unsigned long long b) {
+    const unsigned long long M = (1ull << 61) - 1;
+    return a + b >= M ? a + b - M : a + b;
+}
 
-    for (int i = 1; i <= m; ++i) count[i] += count[i - 1];
+inline unsigned long long __mersenne_sub(unsigned long long a,
+                                         unsigned long long b) {
+    const unsigned long long M = (1ull << 61) - 1;
+    return a >= b ? a - b : a + M - b;
+}
 
-    for (int i = n - 1; i >= 0; --i) b[--count[str[a[i]]]] = a[i];
+inline unsigned long long __hash_base(int k)
+/*
+The k-th (k < 4) hash base of this process, drawn once at random.
+*/
+{
+    struct bases {
+        unsigned long long v[4];
+
+        bases() {
+            std::random_device device;
+            std::mt19937_64 rnd(
+                device() ^
+                std::chrono::steady_clock::now().time_since_epoch().count());
+
+            for (int i = 0; i < 4; ++i)
+                v[i] = (1ull << 16) + rnd() % ((1ull << 61) - (1ull << 17));
+        }
+    };
+    static const bases b;
 
-    delete[] count;
+    return b.v[k];
 }
 }  // namespace detail
 
 namespace ex_string {
-std::vector<int> match(std::string pattern, std::string text)
+#  if __cplusplus >= 201703L
+typedef std::string_view string_ref;
+#  else
+typedef const std::string &string_ref;
+#  endif
+
+class searcher
 /*
-Find the matching position of one string in another.
+Substring search for a fixed pattern at about memory speed, linear in the
+worst case. feed() scans a stream chunk by chunk, including occurrences
+spanning chunk boundaries.
 */
 {
-    int n = pattern.size();
-    std::vector<int> next(n + 1, 0);
+   private:
+    std::string pattern;
+    detail::__two_way two_way;
+    std::string carry;
+    size_t consumed;
 
-    for (int i = 1; i < n; ++i) {
-        int j = i;
+   public:
+    explicit searcher(string_ref p)
+        : pattern(p.data(), p.size()),
+          two_way(pattern.data(), pattern.size()),
+          consumed(0) {}
+
+    searcher(const searcher &other)
+        : pattern(other.pattern),
+          two_way(pattern.data(), pattern.size()),
+          carry(other.carry),
+          consumed(other.consumed) {}
+
+    searcher &operator=(const searcher &other) {
+        pattern = other.pattern, carry = other.carry;
+        consumed = other.consumed;
+        two_way = detail::__two_way(pattern.data(), pattern.size());
+        return *this;
+    }
 
-        if (pattern[j] == pattern[i]) {
-            next[i + 1] = j + 1;
-            break;
+    size_t size() const { return pattern.size(); }
+
+    size_t find(const char *text, size_t n, size_t from = 0) const
+    /*
+    First occurrence in text[from, n), or std::string::npos.
+    */
+    {
+        return detail::__find_bytes(text, n, pattern.data(), pattern.size(),
+                                    from, two_way);
+    }
+
+    size_t find(string_ref text, size_t from = 0) const {
+        return find(text.data(), text.size(), from);
+    }
+
+    template <typename _Func>
+    size_t find_all(const char *text, size_t n, _Func report) const
+    /*
+    Call report(position) for every occurrence, overlapping ones included;
+    returns how many. O(n + m): after an occurrence the next one is at
+    least the shift of the pattern away, and for a periodic pattern the
+    next period is checked by comparing only its last bytes.
+    */
+    {
+        size_t m = pattern.size(), per = two_way.shift(), cnt = 0;
+        bool periodic = two_way.is_periodic();
+
+        for (size_t i = find(text, n); i != std::string::npos;) {
+            report(i), ++cnt;
+
+            if (periodic && i + per + m <= n &&
+                memcmp(text + i + m, pattern.data() + m - per, per) == 0)
+                i += per;
+            else
+                i = find(text, n, i + per);
         }
+
+        return cnt;
     }
 
-    std::vector<int> positions;
+    template <typename _Func>
+    size_t feed(const char *chunk, size_t n, _Func report)
+    /*
+    Continue the stream with a chunk, report(offset) gets the stream offset
+    of every occurrence ending in it; returns how many.
+    */
+    {
+        size_t m = pattern.size(), cnt = 0, base = consumed;
 
-    int m = text.size();
+        if (m == 0) {
+            for (size_t i = consumed ? 1 : 0; i <= n; ++i)
+                report(base + i), ++cnt;
+            consumed += n;
+            return cnt;
+        }
 
-    for (int i = 0, j = 0; i < m; ++i) {
-        if (j < n && text[i] == pattern[j])
-            ++j;
-        else {
-            while (j > 0) {
-                j = next[j];
+        if (!carry.empty()) {
+            // Occurrences starting in the previous chunks.
+            std::string joint = carry;
+            joint.append(chunk, std::min(n, m - 1));
+            size_t start = base - carry.size();
 
-                if (text[i] == pattern[j]) {
-                    ++j;
-                    break;
-                }
-            }
+            for (size_t i = find(joint.data(), joint.size());
+                 i < carry.size(); i = find(joint.data(), joint.size(), i + 1))
+                report(start + i), ++cnt;
+        }
+
+        cnt += find_all(chunk, n, [&](size_t i) { report(base + i); });
+        consumed += n;
+
+        if (n >= m - 1)
+            carry.assign(chunk + n - (m - 1), m - 1);
+        else {
+            carry.append(chunk, n);
+            if (carry.size() > m - 1) carry.erase(0, carry.size() - (m - 1));
         }
 
-        if (j == n) positions.push_back(j);
+        return cnt;
     }
 
+    void reset()
+    /*
+    Start a new stream.
+    */
+    {
+        carry.clear(), consumed = 0;
+    }
+};
+
+std::vector<int> match(string_ref pattern, string_ref text)
+/*
+Find the starting positions of one string in another.
+*/
+{
+    std::vector<int> positions;
+    searcher(pattern).find_all(text.data(), text.size(),
+                               [&](size_t i) { positions.push_back(i); });
     return positions;
 }
 
@@ -164,94 +772,222 @@ Find the smallest representation of the loop string.
     return s.substr(i, n);
 }
 
-void suffix_array(std::string str, int *sa)
+void suffix_array(const std::string &str, int *sa)
 /*
 Find the suffix array of the string.
 The result is stored in array suffix.
 */
 {
-    int m, n = str.size();
+    std::vector<int> res;
+    detail::__suffix_array_sais(
+        reinterpret_cast<const unsigned char *>(str.data()), str.size(), 256,
+        res, (std::vector<int> *)nullptr, 0);
+    std::copy(res.begin(), res.end(), sa);
+}
 
-    for (int i = 0; i < n; ++i) m = std::max(m, (int)str[i]);
+void suffix_array(int *str, int *sa, int n)
+/*
+Suffix array of an integer sequence, every str[i] has to be non-negative.
+*/
+{
+    int m = 0;
 
-    int *rank = new int[2 * n + 1], *a = new int[2 * n + 1],
-        *b = new int[2 * n + 1];
-    memset(rank, 0, (2 * n + 1) * sizeof(int));
-    memset(a, 0, (2 * n + 1) * sizeof(int));
-    memset(b, 0, (2 * n + 1) * sizeof(int));
+    for (int i = 0; i < n; ++i) m = std::max(m, str[i]);
 
-    for (int i = 0; i < n; ++i) rank[i] = i;
+    std::vector<int> res;
+    detail::__suffix_array_sais(str, n, m + 1, res, (std::vector<int> *)nullptr,
+                                0);
+    std::copy(res.begin(), res.end(), sa);
+}
 
-    detail::__suffix_array_radix(str, rank, sa, m);
+template <typename __Idx = int>
+bool suffix_array(const char *str, size_t n, std::vector<__Idx> &sa,
+                  detail::__nondeduced<std::vector<__Idx> > *lcp = nullptr,
+                  size_t memory_budget = 0)
+/*
+Build the suffix array of str[0, n) in linear time (SA-IS), and the LCP
+array as well when lcp is given: (*lcp)[i] is the longest common prefix
+of sa[i - 1] and sa[i], (*lcp)[0] = 0, the same as calc_height.
+__Idx is the signed index type, int for texts below 1G and long long
+beyond, see suffix_array_index_bytes.
+memory_budget limits the scratch memory in bytes beyond the text and
+the output arrays (0 means unlimited).
+Return false if n does not fit __Idx or the budget is too small.
+*/
+{
+    return detail::__suffix_array_sais(
+        reinterpret_cast<const unsigned char *>(str), n, (__Idx)256, sa, lcp,
+        memory_budget);
+}
 
-    rank[sa[0]] = 0;
+template <typename __Idx = int>
+bool suffix_array(const std::string &str, std::vector<__Idx> &sa,
+                  detail::__nondeduced<std::vector<__Idx> > *lcp = nullptr,
+                  size_t memory_budget = 0) {
+    return suffix_array(str.data(), str.size(), sa, lcp, memory_budget);
+}
 
-    for (int i = 1; i < n; ++i)
-        rank[sa[i]] = rank[sa[i - 1]] + (str[sa[i]] != str[sa[i - 1]]);
+size_t suffix_array_index_bytes(size_t n)
+/*
+The narrowest index width (4 or 8 bytes) able to build a suffix array
+of a text of length n.
+*/
+{
+    return n < (size_t)std::numeric_limits<int>::max() / 2 ? 4 : 8;
+}
 
-    for (int i = 0; (1 << i) < n; ++i) {
-        for (int j = 0; j < n; ++j) {
-            a[j] = rank[j] + 1;
-            b[j] = j + (1 << i) >= n ? 0 : rank[j + (1 << i)] + 1;
-            sa[j] = j;
-        }
+template <typename __Idx = int>
+class fm_index
+/*
+Compressed full-text index over a byte string: the BWT in a wavelet
+matrix, plus suffix array samples every `rate` text positions.
+count() takes O(m), locate() O(m + occ * rate) and extract() O(len + rate)
+rank operations, in about n * 1.2 + n / rate * 2 * sizeof(__Idx) bytes.
+*/
+{
+   private:
+    size_t n, rate, dollar;
+    size_t C[257];
+    detail::__wavelet_matrix bwt;
+    detail::__rank_bitvector sampled;
+    std::vector<__Idx> samples, inverse;
+
+    size_t occ(unsigned char c, size_t i) const {
+        return bwt.rank(c, i) - (c == 0 && dollar < i);
+    }
+
+    size_t LF(size_t i) const {
+        unsigned char c = bwt.access(i);
+        return C[c] + occ(c, i);
+    }
+
+    void build(const std::string &text, const std::vector<__Idx> &sa) {
+        std::vector<unsigned char> b(n + 1);
+        std::fill(C, C + 257, 0);
+        sampled.assign(n + 1), inverse.assign(n / rate + 2, 0);
+
+        // Row 0 is the empty suffix, it always gets a sample.
+        b[0] = n ? text[n - 1] : 0, dollar = 0;
+        sampled.set(0), samples.push_back(n);
 
-        detail::__suffix_array_radix(b, sa, rank, n, n);
-        detail::__suffix_array_radix(a, rank, sa, n, n);
-        rank[sa[0]] = 0;
+        for (size_t i = 0; i < n; ++i) {
+            size_t p = sa[i];
+            b[i + 1] = p ? text[p - 1] : 0;
 
-        for (int j = 1; j < n; ++j) {
-            rank[sa[j]] = rank[sa[j - 1]] + (a[sa[j - 1]] != a[sa[j]] ||
-                                             b[sa[j - 1]] != b[sa[j]]);
+            if (!p) dollar = i + 1;
+
+            if (p % rate == 0) {
+                sampled.set(i + 1), samples.push_back(p);
+                inverse[p / rate] = i + 1;
+            }
         }
-    }
 
-    delete[] rank;
-    delete[] a;
-    delete[] b;
-}
+        for (size_t i = 0; i < n; ++i) ++C[(unsigned char)text[i] + 1];
 
-void suffix_array(int *str, int *sa, int n) {
-    int m;
+        C[0] = 1;
 
-    for (int i = 0; i < n; ++i) m = std::max(m, str[i]);
+        for (int c = 1; c <= 256; ++c) C[c] += C[c - 1];
 
-    int *rank = new int[2 * n + 1], *a = new int[2 * n + 1],
-        *b = new int[2 * n + 1];
-    memset(rank, 0, (2 * n + 1) * sizeof(int));
-    memset(a, 0, (2 * n + 1) * sizeof(int));
-    memset(b, 0, (2 * n + 1) * sizeof(int));
+        sampled.build(), bwt.build(b);
+    }
+
+   public:
+    fm_index(const std::string &text, const std::vector<__Idx> &sa,
+             size_t sample_rate = 32)
+        : n(text.size()), rate(std::max<size_t>(sample_rate, 1))
+    /*
+    Build from the text and its suffix array (see suffix_array).
+    */
+    {
+        build(text, sa);
+    }
 
-    for (int i = 0; i < n; ++i) rank[i] = i;
+    explicit fm_index(const std::string &text, size_t sample_rate = 32)
+        : n(text.size()), rate(std::max<size_t>(sample_rate, 1)) {
+        std::vector<__Idx> sa;
+        bool ok = suffix_array(text, sa);
+        assert(ok);
+        build(text, sa);
+    }
 
-    detail::__suffix_array_radix(str, rank, sa, n, m);
+    size_t size() const { return n; }
 
-    rank[sa[0]] = 0;
+    size_t bytes() const
+    /*
+    Memory held by the index.
+    */
+    {
+        return bwt.bytes() + sampled.bytes() +
+               (samples.size() + inverse.size()) * sizeof(__Idx) +
+               sizeof(*this);
+    }
 
-    for (int i = 1; i < n; ++i)
-        rank[sa[i]] = rank[sa[i - 1]] + (str[sa[i]] != str[sa[i - 1]]);
+    std::pair<size_t, size_t> range(const std::string &pattern) const
+    /*
+    The half-open range of suffix array rows prefixed by pattern.
+    */
+    {
+        size_t sp = 0, ep = n + 1;
 
-    for (int i = 0; (1 << i) < n; ++i) {
-        for (int j = 0; j < n; ++j) {
-            a[j] = rank[j] + 1;
-            b[j] = j + (1 << i) >= n ? 0 : rank[j + (1 << i)] + 1;
-            sa[j] = j;
+        for (size_t i = pattern.size(); i-- > 0 && sp < ep;) {
+            unsigned char c = pattern[i];
+            sp = C[c] + occ(c, sp), ep = C[c] + occ(c, ep);
         }
 
-        detail::__suffix_array_radix(b, sa, rank, n, n);
-        detail::__suffix_array_radix(a, rank, sa, n, n);
-        rank[sa[0]] = 0;
+        return std::make_pair(sp, std::max(sp, ep));
+    }
+
+    size_t count(const std::string &pattern) const
+    /*
+    Number of occurrences of pattern in the text.
+    */
+    {
+        std::pair<size_t, size_t> r = range(pattern);
+        return r.second - r.first;
+    }
+
+    std::vector<size_t> locate(const std::string &pattern) const
+    /*
+    Starting positions of every occurrence of pattern, in row order.
+    */
+    {
+        std::pair<size_t, size_t> r = range(pattern);
+        std::vector<size_t> res;
+
+        for (size_t i = r.first; i < r.second; ++i) {
+            size_t row = i, steps = 0;
+
+            for (; !sampled[row]; ++steps) row = LF(row);
 
-        for (int j = 1; j < n; ++j) {
-            rank[sa[j]] = rank[sa[j - 1]] + (a[sa[j - 1]] != a[sa[j]] ||
-                                             b[sa[j - 1]] != b[sa[j]]);
+            res.push_back(samples[sampled.rank1(row)] + steps);
         }
+
+        return res;
     }
 
-    delete[] rank;
-    delete[] a;
-    delete[] b;
-}
+    std::string extract(size_t pos, size_t len) const
+    /*
+    The substring text[pos, pos + len), clipped to the text.
+    */
+    {
+        if (pos >= n) return std::string();
+
+        size_t end = std::min(n, pos + len), k = (end + rate - 1) / rate;
+        size_t p = k * rate > n ? n : k * rate;
+        size_t row = p == n ? 0 : inverse[k];
+        std::string res(end - pos, 0);
+
+        for (; p > pos; --p) {
+            unsigned char c = bwt.access(row);
+
+            if (p <= end) res[p - 1 - pos] = c;
+
+            row = C[c] + occ(c, row);
+        }
+
+        return res;
+    }
+};
 
 void calc_height(std::string str, int *sa, int *h)
 /*
@@ -419,6 +1155,35 @@ Find the longest common substring of two strings.
     delete[] h;
 }
 
+inline int longest_common_subsequence(string_ref a, string_ref b)
+/*
+Length of the longest common subsequence, bit-parallel (see
+sequence::LCS); LCS above is the longest common substring.
+*/
+{
+    return sequence::LCS(a.data(), a.size(), b.data(), b.size());
+}
+
+inline int edit_distance(string_ref a, string_ref b, int band = -1)
+/*
+Levenshtein distance, or -1 if band >= 0 and it exceeds band.
+*/
+{
+    return sequence::edit_distance(a.data(), a.size(), b.data(), b.size(),
+                                   band);
+}
+
+inline int alignment(string_ref a, string_ref b, std::string &ops,
+                     bool substitute = true)
+/*
+Optimal alignment script of a into b in linear memory, see
+sequence::alignment.
+*/
+{
+    return sequence::alignment(a.data(), a.size(), b.data(), b.size(), ops,
+                               substitute);
+}
+
 int find_palindrome(std::string str)
 /*
 Find the length of the longest palindrome substring of the string.
@@ -497,27 +1262,327 @@ Class for string hashing.
         delete[] base;
     }
 
-    void build(std::string str) {
-        n = str.size();
-        h[0] = 0;
+    void build(std::string str) {
+        n = str.size();
+        h[0] = 0;
+
+        for (int i = 1; i <= n; ++i) h[i] = h[i - 1] * PRIME + str[i - 1];
+
+        base[0] = 1;
+
+        for (int i = 1; i <= n; ++i) base[i] = base[i - 1] * PRIME;
+    }
+
+    unsigned long long operator()() { return h[n]; }
+
+    unsigned long long operator()(int l, int r)
+    /*
+    Query the hash value of substring in [l,r].
+    */
+    {
+        return h[r] - h[l] * base[r - l];
+    }
+};
+
+template <int BASES = 1>
+class rolling_hash
+/*
+Polynomial hash modulo the Mersenne prime 2^61-1. Bases are drawn at random
+once per process, so no fixed input is known to collide; BASES = 2 keeps a
+second independent base (a double hash). Storage follows the string length.
+*/
+{
+   public:
+    typedef std::array<unsigned long long, BASES> value_type;
+
+   private:
+    std::string text;
+    std::vector<unsigned long long> h[BASES], pw[BASES];
+
+    static_assert(BASES >= 1 && BASES <= 4, "rolling_hash: 1 to 4 bases");
+
+    static unsigned long long code(char c) { return (unsigned char)c + 1; }
+
+    void prefix(int k, const char *s, size_t n)
+    /*
+    The powers and prefix hashes are each a chain of multiplications, so
+    they are built as four interleaved chains over quarters of the string
+    and the quarters are joined afterwards with independent multiplies.
+    */
+    {
+        using detail::__mersenne_mul;
+        using detail::__mersenne_add;
+        const unsigned long long b = detail::__hash_base(k);
+        std::vector<unsigned long long> &P = pw[k], &H = h[k];
+
+        P.assign(n + 1, 1), H.assign(n + 1, 0);
+
+        if (n < 64) {
+            for (size_t i = 0; i < n; ++i) {
+                P[i + 1] = __mersenne_mul(P[i], b);
+                H[i + 1] = __mersenne_add(__mersenne_mul(H[i], b), code(s[i]));
+            }
+
+            return;
+        }
+
+        for (size_t i = 1; i < 4; ++i) P[i] = __mersenne_mul(P[i - 1], b);
+
+        const unsigned long long b4 = __mersenne_mul(P[3], b);
+
+        for (size_t i = 4; i <= n; i += 4)
+            for (size_t j = 0; j < 4 && i + j <= n; ++j)
+                P[i + j] = __mersenne_mul(P[i + j - 4], b4);
+
+        // H[q * L + x] holds the hash of the x bytes starting at q * L.
+        const size_t L = (n + 3) / 4;
+        unsigned long long a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+        size_t x = 1;
+
+        for (; 3 * L + x <= n; ++x) {
+            a0 = __mersenne_add(__mersenne_mul(a0, b), code(s[x - 1]));
+            a1 = __mersenne_add(__mersenne_mul(a1, b), code(s[L + x - 1]));
+            a2 = __mersenne_add(__mersenne_mul(a2, b), code(s[2 * L + x - 1]));
+            a3 = __mersenne_add(__mersenne_mul(a3, b), code(s[3 * L + x - 1]));
+            H[x] = a0, H[L + x] = a1, H[2 * L + x] = a2, H[3 * L + x] = a3;
+        }
+
+        for (; x <= L; ++x) {
+            a0 = __mersenne_add(__mersenne_mul(a0, b), code(s[x - 1]));
+            a1 = __mersenne_add(__mersenne_mul(a1, b), code(s[L + x - 1]));
+            a2 = __mersenne_add(__mersenne_mul(a2, b), code(s[2 * L + x - 1]));
+            H[x] = a0, H[L + x] = a1, H[2 * L + x] = a2;
+        }
+
+        for (size_t q = 1; q < 4; ++q) {
+            const size_t from = q * L, to = std::min(n, from + L);
+            const unsigned long long head = H[from];
+
+            for (size_t i = from + 1; i <= to; ++i)
+                H[i] = __mersenne_add(__mersenne_mul(head, P[i - from]), H[i]);
+        }
+    }
+
+   public:
+    rolling_hash() { build("", 0); }
+
+    rolling_hash(const char *s, size_t n) { build(s, n); }
+
+    explicit rolling_hash(string_ref s) { build(s.data(), s.size()); }
+
+    void build(const char *s, size_t n) {
+        text.assign(s, n);
+
+        for (int k = 0; k < BASES; ++k) prefix(k, text.data(), n);
+    }
+
+    void build(string_ref s) { build(s.data(), s.size()); }
+
+    size_t size() const { return text.size(); }
+
+    const std::string &str() const { return text; }
+
+    value_type operator()() const { return (*this)(0, text.size()); }
+
+    value_type operator()(size_t l, size_t r) const
+    /*
+    Hash of the substring [l, r).
+    */
+    {
+        value_type v;
+
+        for (int k = 0; k < BASES; ++k)
+            v[k] = detail::__mersenne_sub(
+                h[k][r], detail::__mersenne_mul(h[k][l], pw[k][r - l]));
+
+        return v;
+    }
+
+    static value_type hash(const char *s, size_t n)
+    /*
+    Hash of a standalone string, comparable with substring hashes.
+    */
+    {
+        value_type v;
+
+        for (int k = 0; k < BASES; ++k) {
+            const unsigned long long b = detail::__hash_base(k);
+            v[k] = 0;
+
+            for (size_t i = 0; i < n; ++i)
+                v[k] = detail::__mersenne_add(detail::__mersenne_mul(v[k], b),
+                                              code(s[i]));
+        }
+
+        return v;
+    }
+
+    static value_type hash(string_ref s) { return hash(s.data(), s.size()); }
+
+    bool equal(size_t i, size_t j, size_t len) const
+    /*
+    Whether the substrings of length len at i and j agree.
+    */
+    {
+        return i == j || (*this)(i, i + len) == (*this)(j, j + len);
+    }
+
+    static size_t lcp(const rolling_hash &a, size_t i, const rolling_hash &b,
+                      size_t j)
+    /*
+    Longest common prefix of a's suffix at i and b's suffix at j, by a
+    galloping then binary search over hash comparisons: O(log lcp).
+    */
+    {
+        size_t hi = std::min(a.size() - i, b.size() - j), lo = 0, step = 1;
+
+        if (&a == &b && i == j) return hi;
+
+        // lo always matches; grow it until a probe fails or hits the end.
+        while (lo < hi) {
+            size_t len = std::min(hi, lo + step);
+
+            if (a(i, i + len) != b(j, j + len)) {
+                hi = len - 1;
+                break;
+            }
+
+            lo = len, step <<= 1;
+        }
+
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo + 1) / 2;
+
+            if (a(i, i + mid) == b(j, j + mid))
+                lo = mid;
+            else
+                hi = mid - 1;
+        }
+
+        return lo;
+    }
+
+    size_t lcp(size_t i, size_t j) const { return lcp(*this, i, *this, j); }
+
+    static int compare(const rolling_hash &a, size_t l1, size_t r1,
+                       const rolling_hash &b, size_t l2, size_t r2)
+    /*
+    Three-way lexicographic comparison of a[l1, r1) and b[l2, r2) through
+    their longest common prefix.
+    */
+    {
+        size_t n1 = r1 - l1, n2 = r2 - l2;
+        size_t k = std::min(lcp(a, l1, b, l2), std::min(n1, n2));
+
+        if (k < n1 && k < n2) {
+            unsigned char x = a.text[l1 + k], y = b.text[l2 + k];
+            return x < y ? -1 : 1;
+        }
+
+        return n1 == n2 ? 0 : (n1 < n2 ? -1 : 1);
+    }
+
+    int compare(size_t l1, size_t r1, size_t l2, size_t r2) const {
+        return compare(*this, l1, r1, *this, l2, r2);
+    }
+};
+
+template <typename _Func>
+size_t rabin_karp(string_ref text, const std::vector<std::string> &patterns,
+                  _Func report)
+/*
+Rabin-Karp search for many patterns at once. Patterns are grouped by length,
+one rolling window per length slides over the text and looks its hash up in
+the group; candidates are confirmed with memcmp. report(id, position) gets
+every occurrence in text order, returns how many. O(n) per distinct length.
+*/
+{
+    using detail::__mersenne_mul;
+    using detail::__mersenne_add;
+    using detail::__mersenne_sub;
+
+    struct group {
+        size_t len;
+        unsigned long long top, window;
+        std::unordered_map<unsigned long long, int> head;
+    };
+
+    const unsigned long long b = detail::__hash_base(0);
+    const char *s = text.data();
+    const size_t n = text.size();
+    std::vector<group> groups;
+    std::vector<int> next(patterns.size(), -1);
+    std::map<size_t, size_t> by_length;
+
+    for (size_t id = 0; id < patterns.size(); ++id) {
+        const std::string &p = patterns[id];
+
+        if (p.size() > n) continue;
+
+        if (!by_length.count(p.size())) {
+            by_length[p.size()] = groups.size();
+            groups.push_back(group());
+            groups.back().len = p.size();
+        }
+
+        group &g = groups[by_length[p.size()]];
+        unsigned long long v = rolling_hash<1>::hash(p)[0];
+        auto it = g.head.find(v);
+
+        if (it != g.head.end()) next[id] = it->second;
+
+        g.head[v] = id;
+    }
+
+    for (size_t k = 0; k < groups.size(); ++k) {
+        group &g = groups[k];
+        g.top = 1, g.window = 0;
+
+        for (size_t i = 0; i + 1 < g.len; ++i) g.top = __mersenne_mul(g.top, b);
+
+        for (size_t i = 0; i < g.len; ++i)
+            g.window = __mersenne_add(__mersenne_mul(g.window, b),
+                                      (unsigned char)s[i] + 1);
+    }
+
+    size_t cnt = 0;
+    std::vector<int> hits;
 
-        for (int i = 1; i <= n; ++i) h[i] = h[i - 1] * PRIME + str[i - 1];
+    for (size_t pos = 0; pos <= n; ++pos)
+        for (size_t k = 0; k < groups.size(); ++k) {
+            group &g = groups[k];
 
-        base[0] = 1;
+            if (pos + g.len > n) continue;
 
-        for (int i = 1; i <= n; ++i) base[i] = base[i - 1] * PRIME;
-    }
+            if (pos) {
+                // Slide the window one byte: drop s[pos-1], take s[pos+len-1].
+                unsigned long long w = g.window;
 
-    unsigned long long operator()() { return h[n]; }
+                if (g.len) {
+                    unsigned char out = s[pos - 1], in = s[pos + g.len - 1];
+                    w = __mersenne_sub(w, __mersenne_mul(g.top, out + 1));
+                    w = __mersenne_add(__mersenne_mul(w, b), in + 1);
+                }
 
-    unsigned long long operator()(int l, int r)
-    /*
-    Query the hash value of substring in [l,r].
-    */
-    {
-        return h[r] - h[l] * base[r - l];
-    }
-};
+                g.window = w;
+            }
+
+            auto it = g.head.find(g.window);
+
+            if (it == g.head.end()) continue;
+
+            // Ids chain from the last inserted; report them in insertion order.
+            hits.clear();
+
+            for (int id = it->second; id != -1; id = next[id])
+                if (memcmp(patterns[id].data(), s + pos, g.len) == 0)
+                    hits.push_back(id);
+
+            for (size_t t = hits.size(); t--;) report(hits[t], pos), ++cnt;
+        }
+
+    return cnt;
+}
 
 template <size_t size, const int CHARSET = 26, const int CHARBASE = 'a'>
 class Aho_Corasick_Automaton {
@@ -611,6 +1676,241 @@ class Aho_Corasick_Automaton {
     }
 };
 
+class aho_corasick
+/*
+Aho-Corasick automaton over bytes, built into a full DFA: every byte is
+one transition, never a walk along failure links. Bytes that occur in no
+pattern share one class, and a state stores only the transitions differing
+from the root's, found by a bitmap and popcount, so memory follows the
+patterns' size rather than 256 entries per state.
+Matching leaves the automaton untouched; insert every pattern before
+build().
+*/
+{
+   private:
+    typedef unsigned long long word;
+
+    std::vector<std::map<unsigned char, int> > trie;
+    std::vector<int> out, link, next_id, length;
+    unsigned char cls[256];
+    int classes, words;
+    std::vector<int> root, offset, target;
+    std::vector<word> bits;
+
+    int delta(int u, int c) const {
+        const word *b = &bits[(size_t)u * words];
+        int w = c >> 6;
+        word bit = (word)1 << (c & 63);
+
+        if (!(b[w] & bit)) return root[c];
+
+        int r = offset[u] + __builtin_popcountll(b[w] & (bit - 1));
+
+        for (int i = 0; i < w; ++i) r += __builtin_popcountll(b[i]);
+
+        return target[r];
+    }
+
+   public:
+    class stream
+    /*
+    Matching state carried across the buffers of one text.
+    */
+    {
+       private:
+        const aho_corasick *ac;
+        int state;
+        size_t consumed;
+        bool started;
+
+       public:
+        explicit stream(const aho_corasick &a)
+            : ac(&a), state(0), consumed(0), started(false) {}
+
+        template <typename _Func>
+        size_t feed(const char *s, size_t n, _Func report)
+        /*
+        Continue the text with s[0, n): report(id, offset) gets every
+        occurrence ending in it, offset being where it starts in the
+        text; returns how many.
+        */
+        {
+            const unsigned char *p = (const unsigned char *)s;
+            const aho_corasick &A = *ac;
+            size_t cnt = 0;
+
+            assert(A.built());
+
+            if (!started)
+                for (int id = A.out[0]; id >= 0; id = A.next_id[id])
+                    report(id, (size_t)0), ++cnt;
+
+            started = true;
+
+            for (size_t i = 0; i < n; ++i) {
+                state = A.delta(state, A.cls[p[i]]);
+
+                int t = A.out[state] >= 0 ? state : A.link[state];
+
+                for (; t >= 0; t = A.link[t])
+                    for (int id = A.out[t]; id >= 0; id = A.next_id[id])
+                        report(id, consumed + i + 1 - A.length[id]), ++cnt;
+            }
+
+            consumed += n;
+            return cnt;
+        }
+
+        void reset()
+        /*
+        Start a new text.
+        */
+        {
+            state = 0, consumed = 0, started = false;
+        }
+    };
+
+    aho_corasick() : trie(1), out(1, -1), classes(1), words(1), root(1, 0) {
+        memset(cls, 0, sizeof(cls));
+        offset.assign(1, 0), bits.assign(1, 0);
+    }
+
+    size_t size() const
+    /*
+    Number of patterns.
+    */
+    {
+        return length.size();
+    }
+
+    bool built() const
+    /*
+    Whether build() has run; matching requires it.
+    */
+    {
+        return !link.empty();
+    }
+
+    size_t bytes() const
+    /*
+    Memory taken by the built automaton.
+    */
+    {
+        return out.size() * 3 * sizeof(int) + target.size() * sizeof(int) +
+               bits.size() * sizeof(word) + root.size() * sizeof(int);
+    }
+
+    int insert(const std::string &str)
+    /*
+    Add a pattern, returns its id.
+    */
+    {
+        int now = 0;
+
+        assert(!built());
+
+        for (size_t i = 0; i < str.size(); ++i) {
+            unsigned char v = str[i];
+            std::map<unsigned char, int>::iterator it = trie[now].find(v);
+
+            if (it == trie[now].end()) {
+                trie[now][v] = trie.size();
+                now = trie.size();
+                trie.push_back(std::map<unsigned char, int>());
+                out.push_back(-1);
+            } else
+                now = it->second;
+        }
+
+        int id = length.size();
+        length.push_back(str.size()), next_id.push_back(out[now]);
+        out[now] = id;
+        return id;
+    }
+
+    void build() {
+        assert(!built());
+
+        int n = trie.size();
+        std::vector<bool> used(256, false);
+
+        for (int u = 0; u < n; ++u)
+            for (auto &e : trie[u]) used[e.first] = true;
+
+        classes = 1;
+
+        for (int c = 0; c < 256; ++c) cls[c] = used[c] ? classes++ : 0;
+
+        words = (classes + 63) >> 6;
+        root.assign(classes, 0), link.assign(n, -1);
+        offset.assign(n + 1, 0), bits.assign((size_t)n * words, 0);
+        target.clear();
+
+        for (auto &e : trie[0]) root[cls[e.first]] = e.second;
+
+        std::vector<int> fail(n, 0), q(1, 0), row(classes);
+
+        for (size_t h = 0; h < q.size(); ++h) {
+            int u = q[h], f = fail[u];
+
+            // Nearest proper suffix state ending a pattern.
+            if (u) link[u] = out[f] >= 0 ? f : link[f];
+
+            for (int c = 0; c < classes; ++c)
+                row[c] = u ? delta(f, c) : root[c];
+
+            for (auto &e : trie[u]) {
+                int c = cls[e.first];
+                fail[e.second] = u ? row[c] : 0;
+                row[c] = e.second, q.push_back(e.second);
+            }
+
+            // States are numbered in insertion order, so rows are laid out
+            // by BFS order; offset[] is filled as rows are appended.
+            offset[u] = target.size();
+
+            for (int c = 0; c < classes; ++c)
+                if (row[c] != root[c]) {
+                    bits[(size_t)u * words + (c >> 6)] |= (word)1 << (c & 63);
+                    target.push_back(row[c]);
+                }
+        }
+
+        std::vector<std::map<unsigned char, int> >().swap(trie);
+    }
+
+    bool find(const char *s, size_t n) const
+    /*
+    Whether any pattern occurs in s[0, n).
+    */
+    {
+        const unsigned char *p = (const unsigned char *)s;
+        int now = 0;
+
+        assert(built());
+
+        if (out[0] >= 0) return true;
+
+        for (size_t i = 0; i < n; ++i) {
+            now = delta(now, cls[p[i]]);
+
+            if (out[now] >= 0 || link[now] >= 0) return true;
+        }
+
+        return false;
+    }
+
+    template <typename _Func>
+    size_t scan(const char *s, size_t n, _Func report) const
+    /*
+    Call report(id, offset) for every occurrence, offset being where the
+    occurrence starts; returns how many.
+    */
+    {
+        return stream(*this).feed(s, n, report);
+    }
+};
+
 template <size_t size, const int CHARSET = 26, const int CHARBASE = 'a'>
 class Suffix_Automaton {
    private:
@@ -626,8 +1926,8 @@ class Suffix_Automaton {
 
         fa = new int[size];
         l = new int[size];
-        memset(fa, 0, size * sizeof(fa));
-        memset(l, 0, size * sizeof(l));
+        memset(fa, 0, size * sizeof(int));
+        memset(l, 0, size * sizeof(int));
     }
 
     ~Suffix_Automaton() {
@@ -655,7 +1955,7 @@ class Suffix_Automaton {
             else {
                 int nq = ++cnt;
                 l[nq] = l[p] + 1;
-                memcpy(ch[nq], ch[q], sizeof(ch[q]));
+                memcpy(ch[nq], ch[q], CHARSET * sizeof(int));
                 fa[nq] = fa[q];
                 fa[q] = fa[np] = nq;
 
@@ -677,6 +1977,360 @@ class Suffix_Automaton {
     */
 };
 
+class suffix_automaton
+/*
+Suffix automaton over bytes that grows with the text. A state keeps one
+transition inline; more go to a small sorted array in a shared pool, and
+past 32 to a dense row of 256, so a state costs 16 bytes plus its edges.
+The number of distinct substrings is kept up to date on every extend();
+occurrence counts are computed on the first query after the text changed.
+*/
+{
+   private:
+    static const unsigned char Dense = 255;
+    static const unsigned int Small = 32;
+
+    struct State {
+        int len, link;
+        unsigned int edges;
+        unsigned char count, cap, key;
+        bool clone;
+    };
+
+    struct Edge {
+        int target;
+        unsigned char key;
+    };
+
+    std::vector<State> st;
+    std::vector<Edge> pool;
+    std::vector<int> dense;
+    std::vector<unsigned int> spare[6];
+    std::vector<unsigned int> occ;
+    int last;
+    unsigned long long substrings;
+    bool counted;
+
+    unsigned int alloc(unsigned int cap) {
+        std::vector<unsigned int> &f = spare[__builtin_ctz(cap)];
+
+        if (!f.empty()) {
+            unsigned int e = f.back();
+            f.pop_back();
+            return e;
+        }
+
+        unsigned int e = pool.size();
+        pool.resize(e + cap);
+        return e;
+    }
+
+    void set(int v, unsigned char c, int t)
+    /*
+    Add or redirect the transition of v on c.
+    */
+    {
+        State &s = st[v];
+
+        if (s.cap == Dense) {
+            dense[(size_t)s.edges * 256 + c] = t;
+            return;
+        }
+
+        if (s.cap == 0) {
+            if (s.count == 0 || s.key == c) {
+                s.key = c, s.edges = t, s.count = 1;
+                return;
+            }
+
+            // Move the inline edge out to the pool.
+            Edge e = {(int)s.edges, s.key};
+            s.cap = 2, s.edges = alloc(2), pool[s.edges] = e;
+        }
+
+        Edge *e = &pool[s.edges];
+        unsigned int i = 0;
+
+        while (i < s.count && e[i].key < c) ++i;
+
+        if (i < s.count && e[i].key == c) {
+            e[i].target = t;
+            return;
+        }
+
+        if (s.count == s.cap) {
+            if (s.cap == Small) {
+                size_t row = dense.size();
+                dense.resize(row + 256, 0);
+
+                for (unsigned int k = 0; k < s.count; ++k)
+                    dense[row + e[k].key] = e[k].target;
+
+                dense[row + c] = t;
+                spare[__builtin_ctz(s.cap)].push_back(s.edges);
+                s.cap = Dense, s.edges = row / 256;
+                return;
+            }
+
+            unsigned int n = alloc(s.cap * 2);
+            e = &pool[s.edges];
+            std::copy(e, e + s.count, &pool[n]);
+            spare[__builtin_ctz(s.cap)].push_back(s.edges);
+            s.cap *= 2, s.edges = n, e = &pool[n];
+        }
+
+        std::copy_backward(e + i, e + s.count, e + s.count + 1);
+        e[i].key = c, e[i].target = t, s.count++;
+    }
+
+    void copy(int from, int to) {
+        State s = st[from];
+        s.len = st[to].len, s.link = st[to].link, s.clone = true;
+
+        if (s.cap == Dense) {
+            size_t row = dense.size();
+            dense.resize(row + 256);
+            std::copy(dense.begin() + (size_t)s.edges * 256,
+                      dense.begin() + (size_t)s.edges * 256 + 256,
+                      dense.begin() + row);
+            s.edges = row / 256;
+        } else if (s.cap) {
+            unsigned int e = alloc(s.cap);
+            std::copy(pool.begin() + s.edges, pool.begin() + s.edges + s.count,
+                      pool.begin() + e);
+            s.edges = e;
+        }
+
+        st[to] = s;
+    }
+
+    int add(int len) {
+        State s = {len, -1, 0, 0, 0, 0, false};
+        st.push_back(s);
+        return st.size() - 1;
+    }
+
+    std::vector<int> by_length() const
+    /*
+    States in increasing length, by counting sort.
+    */
+    {
+        std::vector<int> bucket(st[last].len + 2, 0), order(st.size());
+
+        for (size_t v = 0; v < st.size(); ++v) ++bucket[st[v].len + 1];
+
+        for (size_t i = 1; i < bucket.size(); ++i) bucket[i] += bucket[i - 1];
+
+        for (size_t v = 0; v < st.size(); ++v) order[bucket[st[v].len]++] = v;
+
+        return order;
+    }
+
+    void count_occurrences() {
+        std::vector<int> order = by_length();
+        occ.assign(st.size(), 0);
+
+        for (size_t v = 1; v < st.size(); ++v) occ[v] = !st[v].clone;
+
+        for (size_t i = order.size(); i-- > 1;)
+            occ[st[order[i]].link] += occ[order[i]];
+
+        counted = true;
+    }
+
+    int walk(const char *s, size_t n) const {
+        int v = 0;
+
+        for (size_t i = 0; i < n && v >= 0; ++i) v = next(v, s[i]);
+
+        return v;
+    }
+
+   public:
+    suffix_automaton() : last(0), substrings(0), counted(false) { add(0); }
+
+    suffix_automaton(const char *s, size_t n)
+        : last(0), substrings(0), counted(false) {
+        add(0), append(s, n);
+    }
+
+    int next(int v, unsigned char c) const
+    /*
+    Transition of state v on c, or -1. State 0 is the initial state.
+    */
+    {
+        const State &s = st[v];
+
+        if (s.cap == 0) return s.count && s.key == c ? (int)s.edges : -1;
+
+        if (s.cap == Dense) {
+            int t = dense[(size_t)s.edges * 256 + c];
+            return t ? t : -1;
+        }
+
+        const Edge *e = &pool[s.edges], *end = e + s.count;
+
+        if (s.count > 8) {
+            e = std::lower_bound(e, end, c, [](const Edge &x, unsigned char k) {
+                return x.key < k;
+            });
+            return e != end && e->key == c ? e->target : -1;
+        }
+
+        for (; e != end; ++e)
+            if (e->key == c) return e->target;
+
+        return -1;
+    }
+
+    void extend(unsigned char c) {
+        int cur = add(st[last].len + 1), p = last;
+
+        for (; p >= 0 && next(p, c) < 0; p = st[p].link) set(p, c, cur);
+
+        if (p < 0)
+            st[cur].link = 0;
+        else {
+            int q = next(p, c);
+
+            if (st[p].len + 1 == st[q].len)
+                st[cur].link = q;
+            else {
+                int nq = add(st[p].len + 1);
+                st[nq].link = st[q].link, copy(q, nq);
+
+                for (; p >= 0 && next(p, c) == q; p = st[p].link) set(p, c, nq);
+
+                st[q].link = st[cur].link = nq;
+            }
+        }
+
+        last = cur, counted = false;
+        substrings += st[cur].len - st[st[cur].link].len;
+    }
+
+    void append(const char *s, size_t n) {
+        for (size_t i = 0; i < n; ++i) extend(s[i]);
+    }
+
+    void append(const std::string &s) { append(s.data(), s.size()); }
+
+    size_t size() const
+    /*
+    Number of states.
+    */
+    {
+        return st.size();
+    }
+
+    size_t length() const
+    /*
+    Length of the text so far.
+    */
+    {
+        return st[last].len;
+    }
+
+    size_t bytes() const {
+        return st.capacity() * sizeof(State) + pool.capacity() * sizeof(Edge) +
+               dense.capacity() * sizeof(int) + occ.capacity() * sizeof(int);
+    }
+
+    unsigned long long distinct() const
+    /*
+    Number of distinct non-empty substrings.
+    */
+    {
+        return substrings;
+    }
+
+    bool contains(const char *s, size_t n) const { return walk(s, n) >= 0; }
+
+    size_t occurrences(const char *s, size_t n)
+    /*
+    Number of (possibly overlapping) occurrences of s in the text.
+    */
+    {
+        if (!n) return length() + 1;
+
+        int v = walk(s, n);
+
+        if (v < 0) return 0;
+
+        if (!counted) count_occurrences();
+
+        return occ[v];
+    }
+
+    static std::string longest_common_substring(
+        const std::vector<std::string> &texts)
+    /*
+    Longest string occurring in every text, the automaton being built over
+    the shortest one only.
+    */
+    {
+        if (texts.empty()) return std::string();
+
+        size_t b = 0;
+
+        for (size_t i = 1; i < texts.size(); ++i)
+            if (texts[i].size() < texts[b].size()) b = i;
+
+        suffix_automaton sam(texts[b].data(), texts[b].size());
+        std::vector<int> order = sam.by_length();
+        size_t n = sam.st.size();
+        std::vector<int> best(n), mx(n), end(n, -1);
+
+        for (size_t v = 0; v < n; ++v) {
+            best[v] = sam.st[v].len;
+            if (!sam.st[v].clone) end[v] = sam.st[v].len - 1;
+        }
+
+        // Any end position of a state is one of its subtree's.
+        for (size_t i = n; i-- > 1;) {
+            int v = order[i], p = sam.st[v].link;
+            if (end[p] < 0) end[p] = end[v];
+        }
+
+        for (size_t t = 0; t < texts.size(); ++t) {
+            if (t == b) continue;
+
+            std::fill(mx.begin(), mx.end(), 0);
+
+            int v = 0, l = 0;
+
+            for (size_t i = 0; i < texts[t].size(); ++i) {
+                unsigned char c = texts[t][i];
+
+                while (v && sam.next(v, c) < 0) {
+                    v = sam.st[v].link;
+                    l = sam.st[v].len;
+                }
+
+                int u = sam.next(v, c);
+
+                if (u >= 0)
+                    v = u, ++l;
+                else
+                    l = 0;
+
+                mx[v] = std::max(mx[v], l);
+            }
+
+            for (size_t i = n; i-- > 1;) {
+                int v = order[i], p = sam.st[v].link;
+                mx[p] = std::max(mx[p], std::min(mx[v], sam.st[p].len));
+            }
+
+            for (size_t v = 0; v < n; ++v) best[v] = std::min(best[v], mx[v]);
+        }
+
+        int v = std::max_element(best.begin(), best.end()) - best.begin();
+        return best[v] ? texts[b].substr(end[v] - best[v] + 1, best[v])
+                       : std::string();
+    }
+};
+
 template <size_t size, const int CHARSET = 26, const int CHARBASE = 'a'>
 class Palindrome_Automaton {
    private:
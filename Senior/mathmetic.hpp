@@ -103,7 +103,7 @@ That is, the integer k satisfying b^k=a(mod m).
 
     a = pow(a, m, p);
 
-    for (LL i = 0, j = 1; i < m; j = multiply(j, a, p), ++j)
+    for (LL i = 0, j = 1; i < m; j = multiply(j, a, p), ++i)
         if (mp.count(j) && i * m >= mp[j]) return i * m - mp[j];
 
     return -1;
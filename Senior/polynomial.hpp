@@ -12,6 +12,9 @@
 #    include <bits/stdc++.h>
 #  endif
 #  include "mathmetic.hpp"
+#  ifdef __AVX2__
+#    include <immintrin.h>
+#  endif
 
 namespace Octinc {
 namespace polynomial {
@@ -31,6 +34,61 @@ int __extend(int x) {
         ;
     return n;
 }
+
+/*
+Montgomery arithmetic modulo ModForm with R = 2^32.
+Values are kept in [0, ModForm) outside of the reduction.
+*/
+constexpr uint32_t __mont_newton(uint32_t x, int k) {
+    return k == 0 ? x
+                  : __mont_newton(x * (2u - uint32_t(ModForm) * x), k - 1);
+}
+
+const uint32_t __mont_mod = ModForm;
+const uint32_t __mont_ninv = 0u - __mont_newton(ModForm, 5);
+const uint32_t __mont_r2 = (1ULL << 32) % ModForm * ((1ULL << 32) % ModForm) %
+                           ModForm;
+
+inline uint32_t __mont_reduce(uint64_t t) {
+    uint32_t m = uint32_t(t) * __mont_ninv;
+    uint32_t r = (t + uint64_t(m) * __mont_mod) >> 32;
+    return r >= __mont_mod ? r - __mont_mod : r;
+}
+inline uint32_t __mont_mul(uint32_t a, uint32_t b) {
+    return __mont_reduce(uint64_t(a) * b);
+}
+inline uint32_t __mont_in(uint32_t a) { return __mont_mul(a, __mont_r2); }
+inline uint32_t __mont_add(uint32_t a, uint32_t b) {
+    a += b;
+    return a >= __mont_mod ? a - __mont_mod : a;
+}
+inline uint32_t __mont_sub(uint32_t a, uint32_t b) {
+    return a >= b ? a - b : a + __mont_mod - b;
+}
+
+#  ifdef __AVX2__
+inline __m256i __mont_mul(__m256i a, __m256i b) {
+    const __m256i P = _mm256_set1_epi32(__mont_mod);
+    const __m256i N = _mm256_set1_epi32(__mont_ninv);
+    __m256i e = _mm256_mul_epu32(a, b);
+    __m256i o =
+        _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+    e = _mm256_add_epi64(e, _mm256_mul_epu32(_mm256_mul_epu32(e, N), P));
+    o = _mm256_add_epi64(o, _mm256_mul_epu32(_mm256_mul_epu32(o, N), P));
+    __m256i r = _mm256_blend_epi32(_mm256_srli_epi64(e, 32), o, 0xAA);
+    return _mm256_min_epu32(r, _mm256_sub_epi32(r, P));
+}
+inline __m256i __mont_add(__m256i a, __m256i b) {
+    const __m256i P = _mm256_set1_epi32(__mont_mod);
+    a = _mm256_add_epi32(a, b);
+    return _mm256_min_epu32(a, _mm256_sub_epi32(a, P));
+}
+inline __m256i __mont_sub(__m256i a, __m256i b) {
+    const __m256i P = _mm256_set1_epi32(__mont_mod);
+    a = _mm256_add_epi32(_mm256_sub_epi32(a, b), P);
+    return _mm256_min_epu32(a, _mm256_sub_epi32(a, P));
+}
+#  endif
 }  // namespace detail
 
 namespace polynomial {
@@ -38,44 +96,191 @@ typedef std::vector<int> polynomial;
 
 const int GRoot = 3;
 
-void NTT(polynomial &A, bool opt) {
-    int n = A.size(), k = 0;
-
-    for (; (1 << k) < n; ++k)
-        ;
+class NTT_plan {
+   private:
+    int n, k;
+    uint32_t inv_n;
+    std::vector<int> rev;
+    std::vector<uint32_t> rt[2];
 
-    polynomial rev(n);
+    NTT_plan(const NTT_plan &) = delete;
+    NTT_plan &operator=(const NTT_plan &) = delete;
 
-    for (int i = 0; i < n; ++i) {
-        rev[i] = rev[i >> 1] >> 1 | (i & 1) << (k - 1);
+    void radix2(uint32_t *a, const uint32_t *w, int m) const {
+        for (int i = 0; i < n; i += m << 1)
+            for (int j = 0; j < m; ++j) {
+                uint32_t p = a[i + j];
+                uint32_t q = detail::__mont_mul(a[i + j + m], w[j]);
+                a[i + j] = detail::__mont_add(p, q);
+                a[i + j + m] = detail::__mont_sub(p, q);
+            }
+    }
 
-        if (i < rev[i]) std::swap(A[i], A[rev[i]]);
+    void radix4(uint32_t *a, const uint32_t *w1, const uint32_t *w2,
+                int m) const {
+        for (int i = 0; i < n; i += m << 2) {
+            uint32_t *a0 = a + i, *a1 = a0 + m, *a2 = a1 + m, *a3 = a2 + m;
+            int j0 = 0;
+#  ifdef __AVX2__
+            for (; j0 + 8 <= m; j0 += 8) {
+                __m256i x = _mm256_loadu_si256((__m256i *)(w1 + j0));
+                __m256i y = _mm256_loadu_si256((__m256i *)(w2 + j0));
+                __m256i z = _mm256_loadu_si256((__m256i *)(w2 + m + j0));
+                __m256i b0 = _mm256_loadu_si256((__m256i *)(a0 + j0));
+                __m256i b1 = detail::__mont_mul(
+                    _mm256_loadu_si256((__m256i *)(a1 + j0)), x);
+                __m256i b2 = _mm256_loadu_si256((__m256i *)(a2 + j0));
+                __m256i b3 = detail::__mont_mul(
+                    _mm256_loadu_si256((__m256i *)(a3 + j0)), x);
+                __m256i c0 = detail::__mont_add(b0, b1);
+                __m256i c1 = detail::__mont_sub(b0, b1);
+                __m256i c2 = detail::__mont_mul(detail::__mont_add(b2, b3), y);
+                __m256i c3 = detail::__mont_mul(detail::__mont_sub(b2, b3), z);
+                _mm256_storeu_si256((__m256i *)(a0 + j0),
+                                    detail::__mont_add(c0, c2));
+                _mm256_storeu_si256((__m256i *)(a2 + j0),
+                                    detail::__mont_sub(c0, c2));
+                _mm256_storeu_si256((__m256i *)(a1 + j0),
+                                    detail::__mont_add(c1, c3));
+                _mm256_storeu_si256((__m256i *)(a3 + j0),
+                                    detail::__mont_sub(c1, c3));
+            }
+#  endif
+            for (int j = j0; j < m; ++j) {
+                uint32_t b0 = a0[j], b1 = detail::__mont_mul(a1[j], w1[j]);
+                uint32_t b2 = a2[j], b3 = detail::__mont_mul(a3[j], w1[j]);
+                uint32_t c0 = detail::__mont_add(b0, b1);
+                uint32_t c1 = detail::__mont_sub(b0, b1);
+                uint32_t c2 =
+                    detail::__mont_mul(detail::__mont_add(b2, b3), w2[j]);
+                uint32_t c3 =
+                    detail::__mont_mul(detail::__mont_sub(b2, b3), w2[m + j]);
+                a0[j] = detail::__mont_add(c0, c2);
+                a2[j] = detail::__mont_sub(c0, c2);
+                a1[j] = detail::__mont_add(c1, c3);
+                a3[j] = detail::__mont_sub(c1, c3);
+            }
+        }
     }
-    for (int l = 2; l <= n; l <<= 1) {
-        int m = l >> 1, w = mathmetic::pow(GRoot, (ModForm - 1) / l, ModForm);
 
-        if (opt) w = mathmetic::prime_inv(w, ModForm);
+   public:
+    explicit NTT_plan(int size) : n(size), k(0), rev(size) {
+        assert(size > 0 && (size & (size - 1)) == 0);
 
-        for (int i = 0; i < n; i += l) {
-            int wk = 1;
+        for (; (1 << k) < n; ++k)
+            ;
 
-            for (int j = 0; j < m; ++j, wk = 1LL * wk * w % ModForm) {
-                int p = A[i + j], q = 1LL * wk * A[i + j + m] % ModForm;
-                A[i + j] = (p + q) % ModForm;
-                A[i + j + m] = (p - q + ModForm) % ModForm;
+        for (int i = 1; i < n; ++i)
+            rev[i] = rev[i >> 1] >> 1 | (i & 1) << (k - 1);
+
+        for (int t = 0; t < 2; ++t) {
+            rt[t].assign(std::max(n, 2), 0);
+
+            for (int m = 1; m < n; m <<= 1) {
+                int w =
+                    mathmetic::pow(GRoot, (ModForm - 1) / (m << 1), ModForm);
+
+                if (t) w = mathmetic::prime_inv(w, ModForm);
+
+                uint32_t wm = detail::__mont_in(w), cur = detail::__mont_in(1);
+
+                for (int j = 0; j < m; ++j, cur = detail::__mont_mul(cur, wm))
+                    rt[t][m + j] = cur;
             }
         }
+
+        inv_n = detail::__mont_in(mathmetic::prime_inv(n, ModForm));
     }
-}
 
-void N_DFT(polynomial &A) { NTT(A, false); }
+    int size() const { return n; }
 
-void N_IDFT(polynomial &A) {
-    NTT(A, true);
-    int t = mathmetic::prime_inv(A.size(), ModForm);
+    void transform(polynomial &A, bool opt) const
+    /*
+    In-place NTT of A (opt = true for the inverse, without the 1/n factor).
+    A.size() must equal size() and every value must lie in [0, ModForm).
+    */
+    {
+        assert((int)A.size() == n);
+        uint32_t *a = reinterpret_cast<uint32_t *>(A.data());
+        const uint32_t *w = rt[opt].data();
 
-    for (auto &x : A) x = 1LL * x * t % ModForm;
-}
+        for (int i = 0; i < n; ++i)
+            if (i < rev[i]) std::swap(a[i], a[rev[i]]);
+
+        int m = 1;
+
+        if (k & 1) radix2(a, w + 1, 1), m = 2;
+
+        for (; m < n; m <<= 2) radix4(a, w + m, w + (m << 1), m);
+    }
+
+    void forward(polynomial &A) const
+    /*
+    Forward transform.
+    */
+    {
+        transform(A, false);
+    }
+
+    void inverse(polynomial &A) const
+    /*
+    Inverse transform, including the 1/n scaling.
+    */
+    {
+        transform(A, true);
+        uint32_t *a = reinterpret_cast<uint32_t *>(A.data());
+
+        for (int i = 0; i < n; ++i) a[i] = detail::__mont_mul(a[i], inv_n);
+    }
+
+    static void dot(polynomial &A, const polynomial &B)
+    /*
+    Pointwise product A[i] = A[i] * B[i] % ModForm.
+    */
+    {
+        int n = std::min(A.size(), B.size()), i = 0;
+        uint32_t *a = reinterpret_cast<uint32_t *>(A.data());
+        const uint32_t *b = reinterpret_cast<const uint32_t *>(B.data());
+#  ifdef __AVX2__
+        const __m256i R2 = _mm256_set1_epi32(detail::__mont_r2);
+
+        for (; i + 8 <= n; i += 8) {
+            __m256i x = _mm256_loadu_si256((__m256i *)(a + i));
+            __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+            x = detail::__mont_mul(detail::__mont_mul(x, y), R2);
+            _mm256_storeu_si256((__m256i *)(a + i), x);
+        }
+#  endif
+        for (; i < n; ++i)
+            a[i] = detail::__mont_in(detail::__mont_mul(a[i], b[i]));
+    }
+
+    static const NTT_plan &get(int size)
+    /*
+    Return the cached plan of the given size (a power of two),
+    building it on first use. Plans live until the program exits.
+    */
+    {
+        static std::mutex lock;
+        static std::unique_ptr<NTT_plan> cache[32];
+        int k = 0;
+
+        for (; (1 << k) < size; ++k)
+            ;
+
+        std::lock_guard<std::mutex> guard(lock);
+
+        if (!cache[k]) cache[k].reset(new NTT_plan(1 << k));
+
+        return *cache[k];
+    }
+};
+
+void NTT(polynomial &A, bool opt) { NTT_plan::get(A.size()).transform(A, opt); }
+
+void N_DFT(polynomial &A) { NTT_plan::get(A.size()).forward(A); }
+
+void N_IDFT(polynomial &A) { NTT_plan::get(A.size()).inverse(A); }
 
 void FWTand(polynomial &A, bool opt) {
     int n = A.size();
@@ -129,6 +334,57 @@ void FWTxor(polynomial &A, bool opt) {
     }
 }
 
+const polynomial &__inverses(int n)
+/*
+Modular inverses of 0..n-1 (the 0 entry is unused), built linearly
+and cached per thread.
+*/
+{
+    static thread_local polynomial iv(2, 1);
+
+    for (int i = iv.size(); i < n; ++i)
+        iv.push_back(1LL * (ModForm - ModForm / i) * iv[ModForm % i] % ModForm);
+
+    return iv;
+}
+
+void __inv_step(const int *A, int *I, int l, polynomial &f, polynomial &g)
+/*
+One Newton step of the power series inverse: I holds A^-1 mod x^l and
+receives A^-1 mod x^2l. Only the middle product A * I [l, 2l) is formed,
+so all five transforms have size 2l. f and g are reused as scratch.
+*/
+{
+    int L = l << 1;
+    const NTT_plan &plan = NTT_plan::get(L);
+
+    f.assign(A, A + L), plan.forward(f);
+    g.assign(I, I + l), g.resize(L, 0), plan.forward(g);
+    NTT_plan::dot(f, g), plan.inverse(f);
+    std::fill(f.begin(), f.begin() + l, 0);
+    plan.forward(f), NTT_plan::dot(f, g), plan.inverse(f);
+
+    for (int i = l; i < L; ++i) I[i] = detail::__decrease(-f[i]);
+}
+
+void __multiply(const int *a, int la, const int *b, int lb, int *c, int lc,
+                polynomial &f, polynomial &g)
+/*
+c[0, lc) = a * b mod x^lc, using f and g as scratch.
+*/
+{
+    la = std::min(la, lc), lb = std::min(lb, lc);
+    int L = detail::__extend(std::max(la + lb - 1, 1));
+    const NTT_plan &plan = NTT_plan::get(L);
+
+    f.assign(a, a + la), f.resize(L, 0);
+    g.assign(b, b + lb), g.resize(L, 0);
+    plan.forward(f), plan.forward(g);
+    NTT_plan::dot(f, g), plan.inverse(f);
+    std::copy(f.begin(), f.begin() + std::min(L, lc), c);
+    std::fill(c + std::min(L, lc), c + lc, 0);
+}
+
 polynomial operator+(polynomial, polynomial);
 polynomial operator+(polynomial, int);
 polynomial operator+(int, polynomial);
@@ -201,12 +457,11 @@ polynomial operator-(polynomial A) {
 }
 polynomial operator*(polynomial A, polynomial B) {
     int n = A.size() + B.size() - 1, N = detail::__extend(n);
-    A.resize(N), N_DFT(A);
-    B.resize(N), N_DFT(B);
-
-    for (int i = 0; i < N; ++i) A[i] = 1LL * A[i] * B[i] % ModForm;
-
-    N_IDFT(A), A.resize(n);
+    const NTT_plan &plan = NTT_plan::get(N);
+    A.resize(N), plan.forward(A);
+    B.resize(N), plan.forward(B);
+    NTT_plan::dot(A, B);
+    plan.inverse(A), A.resize(n);
     return A;
 }
 polynomial operator*(polynomial A, int v) {
@@ -240,27 +495,11 @@ polynomial operator%(polynomial A, polynomial B) {
 polynomial inv(polynomial A) {
     int n = A.size(), N = detail::__extend(n);
     A.resize(N);
-    polynomial I(N, 0);
+    polynomial I(N, 0), f, g;
+    f.reserve(N), g.reserve(N);
     I[0] = mathmetic::prime_inv(A[0], ModForm);
 
-    for (int l = 2; l <= N; l <<= 1) {
-        polynomial P(l), Q(l);
-
-        std::copy(A.begin(), A.begin() + l, P.begin());
-        std::copy(I.begin(), I.begin() + l, Q.begin());
-
-        int L = l << 1;
-
-        P.resize(L), N_DFT(P);
-        Q.resize(L), N_DFT(Q);
-
-        for (int i = 0; i < L; ++i)
-            P[i] = 1LL * Q[i] * (2 - 1LL * P[i] * Q[i] % ModForm + ModForm) %
-                   ModForm;
-
-        N_IDFT(P), P.resize(l);
-        std::copy(P.begin(), P.begin() + l, I.begin());
-    }
+    for (int l = 1; l < N; l <<= 1) __inv_step(A.data(), I.data(), l, f, g);
 
     I.resize(n);
     return I;
@@ -343,9 +582,9 @@ polynomial derivative(polynomial A, bool m = true) {
 polynomial integral(polynomial A, bool m = true) {
     int n = A.size();
     polynomial I(n + 1, 0);
+    const polynomial &iv = __inverses(n + 1);
 
-    for (int i = 1; i <= n; ++i)
-        I[i] = 1LL * mathmetic::prime_inv(i, ModForm) * A[i - 1] % ModForm;
+    for (int i = 1; i <= n; ++i) I[i] = 1LL * iv[i] * A[i - 1] % ModForm;
 
     if (m) I.resize(n);
 
@@ -354,29 +593,28 @@ polynomial integral(polynomial A, bool m = true) {
 polynomial sqrt(polynomial A) {
     int n = A.size(), N = detail::__extend(n);
     A.resize(N);
-    polynomial R(N, 0);
+    polynomial R(N, 0), T(N, 0), E(N, 0), f, g;
+    f.reserve(N << 1), g.reserve(N << 1);
     R[0] = mathmetic::degree(A[0], 2, ModForm);
+    T[0] = mathmetic::prime_inv(R[0], ModForm);
     int i2 = mathmetic::prime_inv(2, ModForm);
 
-    for (int l = 2; l <= N; l <<= 1) {
-        polynomial P(l), Q(l);
+    // R = sqrt(A) mod x^l and T = R^-1 mod x^(l/2) on entry to each round.
+    for (int l = 1; l < N; l <<= 1) {
+        if (l > 1) __inv_step(R.data(), T.data(), l >> 1, f, g);
 
-        std::copy(A.begin(), A.begin() + l, P.begin());
-        std::copy(R.begin(), R.begin() + l, Q.begin());
+        const NTT_plan &plan = NTT_plan::get(l);
+        f.assign(R.begin(), R.begin() + l), plan.forward(f);
+        NTT_plan::dot(f, f), plan.inverse(f);
 
-        polynomial I = inv(Q);
-        int L = l << 1;
-        P.resize(L), N_DFT(P);
-        Q.resize(L), N_DFT(Q);
-        I.resize(L), N_DFT(I);
+        // R^2 mod (x^l - 1) folds the unknown high half onto A mod x^l.
+        for (int i = 0; i < l; ++i)
+            E[i] = detail::__decrease(A[l + i] -
+                                      detail::__decrease(f[i] - A[i]));
 
-        for (int i = 0; i < L; ++i) {
-            Q[i] = 1LL * Q[i] * Q[i] % ModForm;
-            P[i] = 1LL * (P[i] + Q[i]) * i2 % ModForm * I[i] % ModForm;
-        }
+        __multiply(E.data(), l, T.data(), l, R.data() + l, l, f, g);
 
-        N_IDFT(P), P.resize(l);
-        std::copy(P.begin(), P.begin() + l, R.begin());
+        for (int i = l; i < (l << 1); ++i) R[i] = 1LL * R[i] * i2 % ModForm;
     }
 
     R.resize(n);
@@ -388,18 +626,36 @@ polynomial root(polynomial A, int k) {
 polynomial ln(polynomial A) {
     assert(A[0] == 1);
     int n = A.size();
-    return integral(fix(derivative(A) * inv(A), n));
+    polynomial D = derivative(A), I = inv(A), f, g;
+    __multiply(D.data(), n, I.data(), n, D.data(), n, f, g);
+    return integral(D);
 }
 polynomial exp(polynomial A) {
     assert(A[0] == 0);
     int n = A.size(), N = detail::__extend(n);
     A.resize(N);
-    polynomial E(N, 0);
-    E[0] = 1;
+    polynomial E(N, 0), G(N, 0), Q = derivative(A, false), W(N, 0), f, g;
+    f.reserve(N << 1), g.reserve(N << 1);
+    const polynomial &iv = __inverses(N);
+    E[0] = G[0] = 1;
+
+    // E = exp(A) mod x^m and G = E^-1 mod x^(m/2) on entry to each round.
+    for (int m = 1; m < N; m <<= 1) {
+        if (m > 1) __inv_step(E.data(), G.data(), m >> 1, f, g);
+
+        // E' - E * Q vanishes below x^(m-1) and E' has no terms past it.
+        __multiply(E.data(), m, Q.data(), m - 1, W.data(), (m << 1) - 1, f, g);
+
+        for (int i = 0; i < m; ++i) W[i] = detail::__decrease(-W[i + m - 1]);
+
+        // (ln E)' = Q + G * (E' - E * Q); integrate and subtract from A.
+        __multiply(W.data(), m, G.data(), m, W.data(), m, f, g);
 
-    for (int l = 2; l <= N; l <<= 1) {
-        polynomial P = (-ln(fix(E, l)) + fix(A, l) + 1) * fix(E, l);
-        std::copy(P.begin(), P.begin() + l, E.begin());
+        for (int i = 0; i < m; ++i)
+            W[i] = detail::__decrease(A[i + m] -
+                                      1LL * iv[i + m] * W[i] % ModForm);
+
+        __multiply(E.data(), m, W.data(), m, E.data() + m, m, f, g);
     }
 
     E.resize(n);
@@ -436,6 +692,151 @@ polynomial atan(polynomial A) {
     int n = A.size();
     return integral(fix(derivative(A) * inv(1 + fix(A * A, n)), n));
 }
+class multipoint {
+   private:
+    static const int Leaf = 32;
+
+    int n;
+    std::vector<int> pts;
+    std::vector<polynomial> tree;
+
+    void build(int k, int l, int r) {
+        if (r - l < Leaf) {
+            polynomial &T = tree[k];
+            T.assign(1, 1);
+
+            for (int i = l; i <= r; ++i) {
+                T.push_back(0);
+
+                for (int j = T.size() - 1; j > 0; --j)
+                    T[j] = (T[j - 1] + 1LL * (ModForm - pts[i]) * T[j]) %
+                           ModForm;
+
+                T[0] = 1LL * (ModForm - pts[i]) * T[0] % ModForm;
+            }
+
+            return;
+        }
+
+        int mid = (l + r) >> 1;
+        build(k << 1, l, mid), build(k << 1 | 1, mid + 1, r);
+        tree[k] = tree[k << 1] * tree[k << 1 | 1];
+    }
+
+    int horner(const polynomial &R, int x) const {
+        long long v = 0;
+
+        for (int i = R.size() - 1; i >= 0; --i) v = (v * x + R[i]) % ModForm;
+
+        return v;
+    }
+
+    void down(int k, int l, int r, polynomial R, std::vector<int> &res) const {
+        if (R.size() >= tree[k].size()) R = R % tree[k];
+
+        if (r - l < Leaf) {
+            for (int i = l; i <= r; ++i) res[i] = horner(R, pts[i]);
+
+            return;
+        }
+
+        int mid = (l + r) >> 1;
+        down(k << 1, l, mid, R, res), down(k << 1 | 1, mid + 1, r, R, res);
+    }
+
+    polynomial up(int k, int l, int r, const std::vector<int> &c) const {
+        if (r - l < Leaf) {
+            polynomial S(r - l + 1, 0), T(1, 1);
+
+            // Sum of c[i] * prod_{j != i} (x - x_j), grown one point at a time.
+            for (int i = l; i <= r; ++i) {
+                int m = i - l;
+
+                for (int j = m; j > 0; --j)
+                    S[j] = (S[j - 1] + 1LL * (ModForm - pts[i]) * S[j] +
+                            1LL * c[i] * T[j]) %
+                           ModForm;
+
+                S[0] = (1LL * (ModForm - pts[i]) * S[0] + 1LL * c[i] * T[0]) %
+                       ModForm;
+                T.push_back(0);
+
+                for (int j = m + 1; j > 0; --j)
+                    T[j] = (T[j - 1] + 1LL * (ModForm - pts[i]) * T[j]) %
+                           ModForm;
+
+                T[0] = 1LL * (ModForm - pts[i]) * T[0] % ModForm;
+            }
+
+            return S;
+        }
+
+        int mid = (l + r) >> 1;
+        return fix(up(k << 1, l, mid, c) * tree[k << 1 | 1] +
+                       up(k << 1 | 1, mid + 1, r, c) * tree[k << 1],
+                   r - l + 1);
+    }
+
+   public:
+    explicit multipoint(const std::vector<int> &X)
+        : n(X.size()), pts(X), tree(n ? n << 2 : 0) {
+        if (n) build(1, 0, n - 1);
+    }
+
+    const polynomial &product() const
+    /*
+    The polynomial prod (x - X[i]).
+    */
+    {
+        return tree[1];
+    }
+
+    std::vector<int> evaluate(const polynomial &A) const
+    /*
+    Return A(X[0]), A(X[1]), ... in O(n log^2 n).
+    */
+    {
+        std::vector<int> res(n, 0);
+
+        if (n) down(1, 0, n - 1, A, res);
+
+        return res;
+    }
+
+    polynomial interpolate(const std::vector<int> &Y) const
+    /*
+    Return the polynomial of degree < n through (X[i], Y[i]) in O(n log^2 n).
+    The points X[i] must be pairwise distinct.
+    */
+    {
+        assert((int)Y.size() == n);
+
+        if (!n) return polynomial(1, 0);
+
+        std::vector<int> c = evaluate(derivative(tree[1], false));
+
+        for (int i = 0; i < n; ++i)
+            c[i] = 1LL * Y[i] * mathmetic::prime_inv(c[i], ModForm) % ModForm;
+
+        return up(1, 0, n - 1, c);
+    }
+};
+
+std::vector<int> evaluate(const polynomial &A, const std::vector<int> &X)
+/*
+Multipoint evaluation of A at every X[i].
+*/
+{
+    return multipoint(X).evaluate(A);
+}
+
+polynomial interpolate(const std::vector<int> &X, const std::vector<int> &Y)
+/*
+Lagrange interpolation through (X[i], Y[i]).
+*/
+{
+    return multipoint(X).interpolate(Y);
+}
 void print(polynomial A, char mid = ' ') {
     int n = A.size();
 
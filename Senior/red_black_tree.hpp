@@ -14,6 +14,7 @@
 #  if __cplusplus < 201103L && !defined(nullptr)
 #    define nullptr NULL
 #  endif
+#  include "../Junior/thread_pool.hpp"
 namespace Octinc {
 template <typename __Tp, typename __Cmp = std::less<__Tp> >
 /*
@@ -78,6 +79,20 @@ class red_black_tree {
     size_t find_rank(__Tp, Node*);
     void clear(Node*);
 
+    enum { Merge, Union, Intersection, Difference };
+
+    static size_t black_height(Node*);
+    Node* build(const std::vector<__Tp>&, size_t, size_t, int, int, Node*);
+    Node* join(Node*, Node*, Node*);
+    Node* join(Node*, Node*);
+    Node* pop_first(Node*, Node*&);
+    void split(Node*, const __Tp&, bool, Node*&, Node*&);
+    Node* partition(Node*&, Node*&, int, Node*&, Node*&);
+    Node* set_op(Node*, Node*, int);
+    Node* set_op(Node*, Node*, int, thread_pool*);
+    void plan(Node*, Node*, int, int, std::vector<Node*>&,
+              std::vector<Node*>&, std::vector<Node*>&);
+
    public:
     struct iterator : public std::iterator<std::input_iterator_tag, __Tp> {
        private:
@@ -134,6 +149,34 @@ class red_black_tree {
     /*
     Insert a key.
     */
+    template <typename _It>
+    void insert(_It, _It, thread_pool* = nullptr);
+    /*
+    Insert a batch of keys in any order: the batch is sorted, built into a
+    tree and merged in by split and join, O(k log(n / k + 1)) after sorting.
+    */
+    template <typename _It>
+    void build(_It, _It);
+    /*
+    Replace the contents with the sorted range in O(n).
+    */
+    void unite(red_black_tree&, thread_pool* = nullptr);
+    /*
+    Set union with another tree, which is left empty. Keys present in both
+    are kept once. Split and join make it O(m log(n / m + 1)) for sizes
+    m <= n; given a started thread_pool, independent parts run on it.
+    The caller waits for those parts, so never pass the pool from one of
+    its own tasks: the waiting task holds a worker and can deadlock it.
+    The same holds for insert and the other set operations.
+    */
+    void intersect(red_black_tree&, thread_pool* = nullptr);
+    /*
+    Set intersection with another tree, which is left empty.
+    */
+    void subtract(red_black_tree&, thread_pool* = nullptr);
+    /*
+    Set difference, removing the keys of another tree, which is left empty.
+    */
     bool remove(__Tp);
     /*
     Delete the key.
@@ -389,7 +432,7 @@ size_t red_black_tree<__Tp, __Cmp>::find_rank(__Tp v, Node* ptn) {
 }
 template <typename __Tp, typename __Cmp>
 size_t red_black_tree<__Tp, __Cmp>::size() {
-    return _root->s;
+    return _root ? _root->s : 0;
 }
 
 template <typename __Tp, typename __Cmp>
@@ -542,6 +585,322 @@ void red_black_tree<__Tp, __Cmp>::clear() {
     _root = nullptr;
 }
 
+template <typename __Tp, typename __Cmp>
+size_t red_black_tree<__Tp, __Cmp>::black_height(Node* ptn) {
+    size_t h = 0;
+
+    for (; ptn; ptn = ptn->lc) h += !ptn->RBc;
+
+    return h;
+}
+
+template <typename __Tp, typename __Cmp>
+typename red_black_tree<__Tp, __Cmp>::Node* red_black_tree<__Tp, __Cmp>::build(
+    const std::vector<__Tp>& v, size_t l, size_t r, int depth, int red,
+    Node* f)
+/*
+Perfectly balanced tree over v[l, r): every level is full but the deepest,
+which is coloured red so all paths keep the same black height.
+*/
+{
+    if (l >= r) return nullptr;
+
+    size_t m = l + (r - l) / 2;
+    Node* ptn = new Node(v[m], depth == red && depth > 0, f, nullptr, nullptr,
+                         r - l);
+    ptn->lc = build(v, l, m, depth + 1, red, ptn);
+    ptn->rc = build(v, m + 1, r, depth + 1, red, ptn);
+    return ptn;
+}
+
+template <typename __Tp, typename __Cmp>
+typename red_black_tree<__Tp, __Cmp>::Node* red_black_tree<__Tp, __Cmp>::join(
+    Node* l, Node* k, Node* r)
+/*
+Tree of l, k and r, where no key of l is greater than k and none of r is
+smaller: k hangs red where the spine of the taller tree reaches the black
+height of the other, then the double red is repaired. O(height difference).
+*/
+{
+    if (l) l->ftr = nullptr, l->RBc = false;
+    if (r) r->ftr = nullptr, r->RBc = false;
+
+    size_t hl = black_height(l), hr = black_height(r), h;
+    Node *p = nullptr, *c;
+
+    if (hl == hr) {
+        k->lc = l, k->rc = r, k->ftr = nullptr, k->RBc = false;
+        if (l) l->ftr = k;
+        if (r) r->ftr = k;
+        k->maintain();
+        return k;
+    }
+
+    k->RBc = true;
+
+    if (hl > hr) {
+        for (c = l, h = hl; c && (c->RBc || h != hr); c = c->rc)
+            h -= !c->RBc, p = c;
+
+        k->lc = c, k->rc = r, k->ftr = p, p->rc = k;
+        _root = l;
+    } else {
+        for (c = r, h = hr; c && (c->RBc || h != hl); c = c->lc)
+            h -= !c->RBc, p = c;
+
+        k->lc = l, k->rc = c, k->ftr = p, p->lc = k;
+        _root = r;
+    }
+
+    if (k->lc) k->lc->ftr = k;
+    if (k->rc) k->rc->ftr = k;
+
+    k->maintain();
+
+    for (Node* q = p; q; q = q->ftr) q->maintain();
+
+    SolveDoubleRed(k);
+    return _root;
+}
+
+template <typename __Tp, typename __Cmp>
+typename red_black_tree<__Tp, __Cmp>::Node* red_black_tree<__Tp, __Cmp>::join(
+    Node* l, Node* r) {
+    if (!l) return r;
+    if (!r) return l;
+
+    Node* k;
+    r = pop_first(r, k);
+    return join(l, k, r);
+}
+
+template <typename __Tp, typename __Cmp>
+typename red_black_tree<__Tp, __Cmp>::Node*
+red_black_tree<__Tp, __Cmp>::pop_first(Node* ptn, Node*& first)
+/*
+Detach the smallest node of a tree, return the rest.
+*/
+{
+    Node *a = ptn->lc, *b = ptn->rc;
+
+    if (a) a->ftr = nullptr;
+    if (b) b->ftr = nullptr;
+
+    if (!a) {
+        first = ptn;
+        if (b) b->RBc = false;
+        return b;
+    }
+
+    return join(pop_first(a, first), ptn, b);
+}
+
+template <typename __Tp, typename __Cmp>
+void red_black_tree<__Tp, __Cmp>::split(Node* ptn, const __Tp& v,
+                                        bool with_equal, Node*& l, Node*& r)
+/*
+Split a tree into the keys smaller than v (or not greater, with_equal) and
+the rest, in O(log n).
+*/
+{
+    if (!ptn) {
+        l = r = nullptr;
+        return;
+    }
+
+    Node *a = ptn->lc, *b = ptn->rc, *x;
+    __Cmp _cmp;
+
+    if (a) a->ftr = nullptr;
+    if (b) b->ftr = nullptr;
+
+    if (with_equal ? !_cmp(v, ptn->val) : _cmp(ptn->val, v)) {
+        split(b, v, with_equal, x, r);
+        l = join(a, ptn, x);
+    } else {
+        split(a, v, with_equal, l, x);
+        r = join(x, ptn, b);
+    }
+}
+
+template <typename __Tp, typename __Cmp>
+typename red_black_tree<__Tp, __Cmp>::Node*
+red_black_tree<__Tp, __Cmp>::partition(Node*& a, Node*& b, int op, Node*& bl,
+                                       Node*& br)
+/*
+One step of a set operation on the root k of b: a is split around k into
+a (smaller) and b (greater), b's subtrees go to bl and br, and the keys of
+a equal to k are dropped. Returns k if it belongs to the result, else
+frees it.
+*/
+{
+    Node *k = b, *eq = nullptr;
+
+    bl = k->lc, br = k->rc;
+    if (bl) bl->ftr = nullptr;
+    if (br) br->ftr = nullptr;
+
+    split(a, k->val, false, a, b);
+
+    if (op != Merge) split(b, k->val, true, eq, b);
+
+    bool found = eq != nullptr;
+    clear(eq);
+
+    if (op == Difference || (op == Intersection && !found)) {
+        delete k;
+        return nullptr;
+    }
+
+    return k;
+}
+
+template <typename __Tp, typename __Cmp>
+typename red_black_tree<__Tp, __Cmp>::Node*
+red_black_tree<__Tp, __Cmp>::set_op(Node* a, Node* b, int op) {
+    if (!a || !b) {
+        if (op == Intersection) {
+            clear(a), clear(b);
+            return nullptr;
+        }
+
+        if (op == Difference) {
+            clear(b);
+            return a;
+        }
+
+        return a ? a : b;
+    }
+
+    Node *bl, *br, *k = partition(a, b, op, bl, br);
+    Node *x = set_op(a, bl, op), *y = set_op(b, br, op);
+
+    return k ? join(x, k, y) : join(x, y);
+}
+
+template <typename __Tp, typename __Cmp>
+void red_black_tree<__Tp, __Cmp>::plan(Node* a, Node* b, int op, int depth,
+                                       std::vector<Node*>& as,
+                                       std::vector<Node*>& bs,
+                                       std::vector<Node*>& ks)
+/*
+Unfold the top levels of a set operation into independent pairs of trees,
+in key order, with the pivot (or nullptr) between neighbours in ks.
+*/
+{
+    if (depth == 0 || !a || !b) {
+        as.push_back(a), bs.push_back(b);
+        return;
+    }
+
+    Node *bl, *br, *k = partition(a, b, op, bl, br);
+
+    plan(a, bl, op, depth - 1, as, bs, ks);
+    ks.push_back(k);
+    plan(b, br, op, depth - 1, as, bs, ks);
+}
+
+template <typename __Tp, typename __Cmp>
+typename red_black_tree<__Tp, __Cmp>::Node*
+red_black_tree<__Tp, __Cmp>::set_op(Node* a, Node* b, int op,
+                                    thread_pool* pool) {
+    if (!pool) return set_op(a, b, op);
+
+    std::vector<Node*> as, bs, ks;
+    std::mutex m;
+    std::condition_variable cv;
+    size_t done = 0;
+
+    plan(a, b, op, 4, as, bs, ks);
+
+    std::vector<Node*> out(as.size());
+
+    // Every part works on its own tree object: join uses _root as scratch.
+    for (size_t i = 0; i < as.size(); ++i)
+        pool->run([&, i] {
+            red_black_tree part;
+            Node* res = part.set_op(as[i], bs[i], op);
+            std::unique_lock<std::mutex> lock(m);
+            out[i] = res, ++done;
+            cv.notify_one();
+        });
+
+    {
+        std::unique_lock<std::mutex> lock(m);
+
+        while (done < as.size()) cv.wait(lock);
+    }
+
+    Node* res = out[0];
+
+    for (size_t i = 0; i < ks.size(); ++i)
+        res = ks[i] ? join(res, ks[i], out[i + 1]) : join(res, out[i + 1]);
+
+    return res;
+}
+
+template <typename __Tp, typename __Cmp>
+template <typename _It>
+void red_black_tree<__Tp, __Cmp>::build(_It first, _It last) {
+    std::vector<__Tp> v(first, last);
+    int red = 0;
+
+    while ((size_t(2) << red) <= v.size()) ++red;
+
+    clear();
+    _root = build(v, 0, v.size(), 0, red, nullptr);
+}
+
+template <typename __Tp, typename __Cmp>
+template <typename _It>
+void red_black_tree<__Tp, __Cmp>::insert(_It first, _It last,
+                                         thread_pool* pool) {
+    red_black_tree batch;
+    std::vector<__Tp> v(first, last);
+
+    std::sort(v.begin(), v.end(), __Cmp());
+    batch.build(v.begin(), v.end());
+    _root = set_op(_root, batch._root, Merge, pool);
+
+    if (_root) _root->ftr = nullptr, _root->RBc = false;
+}
+
+template <typename __Tp, typename __Cmp>
+void red_black_tree<__Tp, __Cmp>::unite(red_black_tree& other,
+                                        thread_pool* pool) {
+    if (&other == this) return;
+
+    _root = set_op(_root, other._root, Union, pool);
+    other._root = nullptr;
+
+    if (_root) _root->ftr = nullptr, _root->RBc = false;
+}
+
+template <typename __Tp, typename __Cmp>
+void red_black_tree<__Tp, __Cmp>::intersect(red_black_tree& other,
+                                            thread_pool* pool) {
+    if (&other == this) return;
+
+    _root = set_op(_root, other._root, Intersection, pool);
+    other._root = nullptr;
+
+    if (_root) _root->ftr = nullptr, _root->RBc = false;
+}
+
+template <typename __Tp, typename __Cmp>
+void red_black_tree<__Tp, __Cmp>::subtract(red_black_tree& other,
+                                           thread_pool* pool) {
+    if (&other == this) {
+        clear();
+        return;
+    }
+
+    _root = set_op(_root, other._root, Difference, pool);
+    other._root = nullptr;
+
+    if (_root) _root->ftr = nullptr, _root->RBc = false;
+}
+
 #undef bro
 #undef islc
 #undef isrc
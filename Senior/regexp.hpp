@@ -169,6 +169,7 @@ pond)".
 #    define STD_BITS_STDCPP_H
 #    include <bits/stdc++.h>
 #  endif
+#  include "ex_string.hpp"
 #  if __cplusplus < 201103L && !defined(nullptr)
 #    define nullptr NULL
 #  endif
@@ -176,7 +177,7 @@ pond)".
 const char REGEXP_ESC = '%';
 const char *REGEXP_SPECIALS = "^$*+?.([%-";
 const int CAP_POSITION = -2;
-const int CAP_UNFINISHED = -1；
+const int CAP_UNFINISHED = -1;
 const int ERR_INVALID_CAPTURE_INDEX = -1;
 const int ERR_INVALID_PATTERN_CAPTURE = -2;
 const int ERR_MALFORMED_PATTERN_ENDS_WITH_ESCAPE = -3;
@@ -195,6 +196,7 @@ unsigned char uchar(_Tp x) {
 }
 namespace Octinc {
 class regexp;
+class regexp_set;
 
 typedef void (*GlobalMatchCallback)(const char *match,
                                     const unsigned int length,
@@ -285,6 +287,297 @@ int __regexp_single_match(int c, const char *p, const char *ep) {
             return (uchar(*p) == c);
     }
 }
+
+const char *__regexp_class_end(const char *p, char &err)
+/*
+End of the single-character class at p, or nullptr with err set.
+*/
+{
+    switch (*p++) {
+        case REGEXP_ESC: {
+            if (*p == '\0') {
+                err = ERR_MALFORMED_PATTERN_ENDS_WITH_ESCAPE;
+                return nullptr;
+            }
+            return p + 1;
+        }
+        case '[': {
+            if (*p == '^') p++;
+            do {
+                if (*p == '\0') {
+                    err = ERR_MALFORMED_PATTERN_ENDS_WITH_RH_SQUARE_BRACKET;
+                    return nullptr;
+                }
+                if (*(p++) == REGEXP_ESC && *p != '\0') p++;
+            } while (*p != ']');
+            return p + 1;
+        }
+        default: { return p; }
+    }
+}
+
+struct __regexp_inst {
+    enum code { CONSUME, SPLIT, JMP, END, FRONTIER, MATCH } op;
+    int x, y;
+};
+
+class __regexp_dfa
+/*
+Lazily built DFA over a Thompson NFA whose threads are kept in priority
+order, so the end of the leftmost-first match agrees with the
+backtracking matcher (or the longest match when longest is set).
+A state is the ordered list of NFA threads plus, for each %f frontier,
+whether the previous byte was in its set.
+*/
+{
+   public:
+    enum { End = 256, Unknown = -1, MaxStates = 4096 };
+
+    std::vector<__regexp_inst> inst;
+    std::vector<std::bitset<256> > sets;
+    std::vector<int> frontiers, entry;
+    bool longest, reversed, all;
+
+    __regexp_dfa() : longest(false), reversed(false), all(false) {}
+
+    void assemble(const std::vector<__regexp_inst> &items, bool unanchored)
+    /*
+    Lay out the NFA for a sequence of items, where a CONSUME item keeps
+    its quantifier in y. An unanchored program starts with a lazy .*
+    */
+    {
+        inst.clear(), frontiers.clear(), clear();
+        entry.assign(1, 0);
+
+        if (unanchored) {
+            sets.push_back(std::bitset<256>().set());
+            emit(__regexp_inst::SPLIT, 3, 1);
+            emit(__regexp_inst::CONSUME, sets.size() - 1);
+            emit(__regexp_inst::JMP, 0);
+        }
+
+        append(items, 0);
+    }
+
+    int append(const std::vector<__regexp_inst> &items, int id)
+    /*
+    Lay out one more pattern, ending in a MATCH of the given id, and
+    return its first instruction.
+    */
+    {
+        int begin = inst.size();
+
+        for (size_t i = 0; i < items.size(); ++i) {
+            const __regexp_inst &I = items[i];
+            int pc = inst.size();
+
+            if (I.op == __regexp_inst::FRONTIER) {
+                emit(__regexp_inst::FRONTIER, I.x, frontiers.size());
+                frontiers.push_back(I.x);
+                continue;
+            }
+
+            if (I.op != __regexp_inst::CONSUME) {
+                emit(I.op);
+                continue;
+            }
+
+            switch (I.y) {
+                case '?':
+                    emit(__regexp_inst::SPLIT, pc + 1, pc + 2);
+                    emit(__regexp_inst::CONSUME, I.x);
+                    break;
+                case '+':
+                    emit(__regexp_inst::CONSUME, I.x), ++pc;
+                    // fall through
+                case '*':
+                    emit(__regexp_inst::SPLIT, pc + 1, pc + 3);
+                    emit(__regexp_inst::CONSUME, I.x);
+                    emit(__regexp_inst::JMP, pc);
+                    break;
+                case '-':
+                    emit(__regexp_inst::SPLIT, pc + 3, pc + 1);
+                    emit(__regexp_inst::CONSUME, I.x);
+                    emit(__regexp_inst::JMP, pc);
+                    break;
+                default:
+                    emit(__regexp_inst::CONSUME, I.x);
+            }
+        }
+
+        emit(__regexp_inst::MATCH, id);
+        return begin;
+    }
+
+    void assemble_all(const std::vector<int> &begins,
+                      const std::vector<bool> &unanchored)
+    /*
+    After append()ing every pattern, start each at the first byte and the
+    unanchored ones again after every byte. Reached MATCHes stay in the
+    state, so the final state tells every pattern that matched.
+    */
+    {
+        int loop = inst.size();
+        sets.push_back(std::bitset<256>().set());
+        emit(__regexp_inst::CONSUME, sets.size() - 1);
+
+        for (size_t i = 0; i < begins.size(); ++i)
+            if (unanchored[i])
+                emit(__regexp_inst::SPLIT, begins[i], inst.size() + 1);
+
+        emit(__regexp_inst::JMP, loop);
+        entry = begins, entry.push_back(loop);
+        longest = all = true, clear();
+    }
+
+    void report(int s, std::vector<int> &ids)
+    /*
+    Ids of the MATCHes reached in state s at the end of the input.
+    */
+    {
+        std::vector<int> k;
+        bool m;
+        step(states[s].first, states[s].second, End, 0, k, m);
+
+        for (size_t i = 0; i < list.size(); ++i)
+            if (inst[list[i]].op == __regexp_inst::MATCH)
+                ids.push_back(inst[list[i]].x);
+
+        std::sort(ids.begin(), ids.end());
+    }
+
+    int start(int prev) {
+        if (first.empty()) first.assign(256, Unknown);
+        if (first[prev] == Unknown)
+            first[prev] = intern(entry, mask(prev));
+        return first[prev];
+    }
+
+    int next(int s, int c, bool &matched)
+    /*
+    Transition on byte c (or End); matched tells whether a match ends
+    right before c.
+    */
+    {
+        int t = trans[s * 257 + c];
+
+        if (t == Unknown) {
+            std::vector<int> k;
+            int pm = step(states[s].first, states[s].second, c,
+                          c == End ? 0 : c, k, matched);
+
+            if (states.size() >= (size_t)MaxStates) {
+                // Flush the cache, keeping only the current state.
+                std::pair<std::vector<int>, int> cur = states[s];
+                clear(), s = intern(cur.first, cur.second);
+            }
+
+            trans[s * 257 + c] = t = intern(k, pm) << 1 | matched;
+        }
+
+        matched = t & 1;
+        return t >> 1;
+    }
+
+    bool dead(int s) const { return states[s].first.empty(); }
+
+    void clear() { states.clear(), ids.clear(), trans.clear(), first.clear(); }
+
+   private:
+    std::vector<std::pair<std::vector<int>, int> > states;
+    std::map<std::pair<std::vector<int>, int>, int> ids;
+    std::vector<int> trans, mark, first;
+    std::vector<int> list;
+    int stamp = 0;
+    bool cut = false, hit = false;
+
+    void emit(int op, int x = 0, int y = 0) {
+        __regexp_inst I;
+        I.op = (__regexp_inst::code)op, I.x = x, I.y = y;
+        inst.push_back(I);
+    }
+
+    int mask(int c) const {
+        int pm = 0;
+
+        for (size_t k = 0; k < frontiers.size(); ++k)
+            if (c != End && sets[frontiers[k]][c]) pm |= 1 << k;
+
+        return pm;
+    }
+
+    int intern(const std::vector<int> &kernel, int pm) {
+        std::pair<std::vector<int>, int> key(kernel, pm);
+        auto it = ids.find(key);
+
+        if (it != ids.end()) return it->second;
+
+        int id = states.size();
+        states.push_back(key), ids[key] = id;
+        trans.resize(states.size() * 257, (int)Unknown);
+        return id;
+    }
+
+    void add(int pc, int pm, int c, int ac) {
+        if (cut || mark[pc] == stamp) return;
+
+        mark[pc] = stamp;
+        const __regexp_inst &I = inst[pc];
+
+        switch (I.op) {
+            case __regexp_inst::JMP:
+                add(I.x, pm, c, ac);
+                break;
+            case __regexp_inst::SPLIT:
+                add(I.x, pm, c, ac), add(I.y, pm, c, ac);
+                break;
+            case __regexp_inst::END:
+                if (c == End) add(pc + 1, pm, c, ac);
+                break;
+            case __regexp_inst::FRONTIER: {
+                bool before = pm >> I.y & 1, after = sets[I.x][ac];
+
+                if (reversed ? before && !after : !before && after)
+                    add(pc + 1, pm, c, ac);
+
+                break;
+            }
+            case __regexp_inst::CONSUME:
+                list.push_back(pc);
+                break;
+            case __regexp_inst::MATCH:
+                hit = true, cut = !longest;
+                if (all) list.push_back(pc);
+                break;
+        }
+    }
+
+    int step(const std::vector<int> &kernel, int pm, int c, int ac,
+             std::vector<int> &out, bool &matched) {
+        if (mark.size() < inst.size()) mark.assign(inst.size(), 0);
+
+        ++stamp, list.clear(), cut = hit = false;
+
+        for (size_t i = 0; i < kernel.size() && !cut; ++i)
+            add(kernel[i], pm, c, ac);
+
+        matched = hit, ++stamp, out.clear();
+
+        if (c != End)
+            for (size_t i = 0; i < list.size(); ++i) {
+                const __regexp_inst &I = inst[list[i]];
+                int pc = list[i] + (I.op == __regexp_inst::CONSUME);
+
+                if ((pc == list[i] || sets[I.x][c]) && mark[pc] != stamp)
+                    mark[pc] = stamp, out.push_back(pc);
+            }
+
+        // Without priorities the order of threads is irrelevant.
+        if (longest) std::sort(out.begin(), out.end());
+
+        return mask(c);
+    }
+};
 }  // namespace detail
 
 class regexp {
@@ -315,6 +608,51 @@ class regexp {
     } capture[MAXCAPTURES];
 
    public:
+    class program
+    /*
+    A pattern compiled once into a lazily built DFA, so each match is a
+    single forward scan for the end and a reverse scan for the start.
+    Patterns using %b or back references are kept for the backtracking
+    matcher; captures are filled by one anchored backtracking run.
+    Matching grows the DFA cache inside the program even through a const
+    reference, so a program must not be shared between threads; give each
+    thread its own copy.
+    */
+    {
+       public:
+        program() : program("") {}
+        explicit program(const char *);
+
+        char status() const
+        /*
+        0, or the negative error code of the pattern.
+        */
+        {
+            return error;
+        }
+
+        bool compiled() const
+        /*
+        Whether matches run on the DFA.
+        */
+        {
+            return regular;
+        }
+
+       private:
+        friend class regexp;
+        friend class regexp_set;
+
+        std::string pattern;
+        char error;
+        bool regular, anchored, captures;
+        std::vector<detail::__regexp_inst> items;
+        std::vector<std::bitset<256> > sets;
+        mutable detail::__regexp_dfa forward, backward;
+    };
+
+    static program compile(const char *pattern) { return program(pattern); }
+
     unsigned int start()
     /*
     zero-relative offset of start of match.
@@ -343,6 +681,10 @@ class regexp {
     /*
     Do a match on a supplied pattern and zero-relative starting point.
     */
+    char match(const program &, unsigned int index = 0);
+    /*
+    Same as above with a compiled pattern.
+    */
     char *query_match(char *) const;
     /*
     Return the matching string.
@@ -353,28 +695,60 @@ class regexp {
     */
     char query() const { return result; }
 
-    unsigned int count(const char *);
+    unsigned int count(const char *pattern)
     /*
     Count number of matches on a supplied pattern.
     */
-    unsigned int global_match(const char *, GlobalMatchCallback);
+    {
+        return count_of(pattern);
+    }
+
+    unsigned int count(const program &pattern) { return count_of(pattern); }
+    unsigned int global_match(const char *pattern, GlobalMatchCallback f) {
+        return global_match_of(pattern, f);
+    }
+    unsigned int global_match(const program &pattern, GlobalMatchCallback f) {
+        return global_match_of(pattern, f);
+    }
     /*
     Iterate with a supplied pattern, call function f for each match,
     and returns count of matches.
     */
-    unsigned int replace(const char *, GlobalReplaceCallback,
-                         const unsigned int max_count = 0);
+    unsigned int replace(const char *pattern, GlobalReplaceCallback f,
+                         const unsigned int max_count = 0) {
+        return replace_of(pattern, f, max_count);
+    }
+    unsigned int replace(const program &pattern, GlobalReplaceCallback f,
+                         const unsigned int max_count = 0) {
+        return replace_of(pattern, f, max_count);
+    }
     /*
     Iterate with a supplied pattern, call function f for each match, maximum of
     max_count matches if max_count > 0, returns count of replacements.
     */
-    unsigned int replace(const char *, const char *,
-                         const unsigned int max_count = 0);
+    unsigned int replace(const char *pattern, const char *replacement,
+                         const unsigned int max_count = 0) {
+        return replace_of(pattern, replacement, max_count);
+    }
+    unsigned int replace(const program &pattern, const char *replacement,
+                         const unsigned int max_count = 0) {
+        return replace_of(pattern, replacement, max_count);
+    }
     /*
     Iterate with a supplied pattern, replaces with replacement string, maximum
     of max_count matches if max_count > 0, returns count of replacements.
     */
    private:
+    template <typename _Tp>
+    unsigned int count_of(const _Tp &);
+    template <typename _Tp>
+    unsigned int global_match_of(const _Tp &, GlobalMatchCallback);
+    template <typename _Tp>
+    unsigned int replace_of(const _Tp &, GlobalReplaceCallback,
+                            const unsigned int);
+    template <typename _Tp>
+    unsigned int replace_of(const _Tp &, const char *, const unsigned int);
+
     friend int check_capture(regexp *ms, int l) {
         l -= '1';
         if (l < 0 || l >= ms->level || ms->capture[l].len == CAP_UNFINISHED)
@@ -390,25 +764,10 @@ class regexp {
     }
 
     friend const char *classend(regexp *ms, const char *p) {
-        switch (*p++) {
-            case REGEXP_ESC: {
-                if (*p == '\0')
-                    detail::__regexp_throw_error(
-                        ERR_MALFORMED_PATTERN_ENDS_WITH_ESCAPE);
-                return p + 1;
-            }
-            case '[': {
-                if (*p == '^') p++;
-                do {
-                    if (*p == '\0')
-                        detail::__regexp_throw_error(
-                            ERR_MALFORMED_PATTERN_ENDS_WITH_RH_SQUARE_BRACKET);
-                    if (*(p++) == REGEXP_ESC && *p != '\0') p++;
-                } while (*p != ']');
-                return p + 1;
-            }
-            default: { return p; }
-        }
+        char err = 0;
+        const char *ep = detail::__regexp_class_end(p, err);
+        if (ep == nullptr) detail::__regexp_throw_error(err);
+        return ep;
     }
 
     friend const char *str_match(regexp *ms, const char *s, const char *p);
@@ -612,6 +971,163 @@ char regexp::match(const char *pattern, unsigned int index) {
     return (result = REGEXP_NOMATCH);
 }
 
+regexp::program::program(const char *p)
+    : pattern(p), error(0), regular(true), anchored(false), captures(false) {
+    int opened = 0, total = 0, frontiers = 0;
+
+    if (*p == '^') anchored = true, p++;
+
+    while (*p != '\0') {
+        detail::__regexp_inst I;
+        I.op = detail::__regexp_inst::CONSUME, I.x = sets.size(), I.y = 0;
+
+        if (*p == '(') {
+            captures = true;
+            if (++total > MAXCAPTURES) {
+                error = ERR_TOO_MANY_CAPTURES;
+                return;
+            }
+            if (*(p + 1) == ')')
+                p += 2;
+            else
+                opened++, p++;
+            continue;
+        }
+
+        if (*p == ')') {
+            if (opened-- == 0) {
+                error = ERR_INVALID_PATTERN_CAPTURE;
+                return;
+            }
+            p++;
+            continue;
+        }
+
+        if (*p == '$' && *(p + 1) == '\0') {
+            I.op = detail::__regexp_inst::END;
+            items.push_back(I);
+            break;
+        }
+
+        if (*p == REGEXP_ESC && (*(p + 1) == 'b' || isdigit(uchar(*(p + 1))))) {
+            // Not a regular language, matched by backtracking only.
+            regular = false;
+            return;
+        }
+
+        bool frontier = *p == REGEXP_ESC && *(p + 1) == 'f';
+
+        if (frontier) {
+            p += 2;
+            if (*p != '[') {
+                error = ERR_MISSING_LH_SQUARE_BRACKET_AFTER_ESC_F;
+                return;
+            }
+            I.op = detail::__regexp_inst::FRONTIER, frontiers++;
+        }
+
+        const char *ep = detail::__regexp_class_end(p, error);
+
+        if (ep == nullptr) return;
+
+        std::bitset<256> set;
+
+        for (int c = 0; c < 256; ++c)
+            set[c] = frontier
+                         ? detail::__regexp_match_bracket_class(c, p, ep - 1)
+                         : detail::__regexp_single_match(c, p, ep);
+
+        sets.push_back(set);
+
+        if (!frontier && *ep != '\0' && strchr("?*+-", *ep)) I.y = *ep++;
+
+        items.push_back(I), p = ep;
+    }
+
+    if (frontiers > 30) {
+        regular = false;
+        return;
+    }
+
+    forward.sets = sets;
+    forward.assemble(items, !anchored);
+
+    if (anchored) return;
+
+    // The start is the leftmost position a match ending at the end found
+    // can begin from, any match will do there.
+    std::vector<detail::__regexp_inst> mirrored(items.rbegin(), items.rend());
+    if (!mirrored.empty() && mirrored[0].op == detail::__regexp_inst::END)
+        mirrored.erase(mirrored.begin());
+    backward.sets = sets;
+    backward.longest = backward.reversed = true;
+    backward.assemble(mirrored, false);
+}
+
+char regexp::match(const program &prog, unsigned int index) {
+    if (prog.error) return (result = prog.error);
+
+    if (!prog.regular) return match(prog.pattern.c_str(), index);
+
+    if (!src) return (result = ERR_NO_TARGET_STRING);
+
+    if (index > src_len) index = src_len;
+
+    const detail::byte *s = (const detail::byte *)src;
+    detail::__regexp_dfa &F = prog.forward, &B = prog.backward;
+    int state = F.start(index ? s[index - 1] : 0);
+    long long end = -1;
+    bool matched;
+
+    for (unsigned int i = index;; ++i) {
+        if (i == src_len) {
+            F.next(state, F.End, matched);
+            if (matched) end = i;
+            break;
+        }
+
+        state = F.next(state, s[i], matched);
+        if (matched) end = i;
+        if (F.dead(state)) break;
+    }
+
+    if (end < 0) return (result = REGEXP_NOMATCH);
+
+    unsigned int begin = index;
+
+    if (!prog.anchored) {
+        state = B.start(end < src_len ? s[end] : 0), begin = end;
+
+        for (unsigned int i = end;; --i) {
+            if (i == 0) {
+                B.next(state, B.End, matched);
+                if (matched) begin = i;
+                break;
+            }
+
+            state = B.next(state, s[i - 1], matched);
+            if (matched) begin = i;
+            if (i == index || B.dead(state)) break;
+        }
+    }
+
+    MatchStart = begin;
+    MatchLength = end - begin;
+    level = 0;
+
+    if (prog.captures) {
+        char rtn = setjmp(detail::regexp___regexp_throw_error_return);
+
+        if (rtn) return ((result = rtn));
+
+        const char *pattern = prog.pattern.c_str() + prog.anchored;
+        src_end = src + src_len;
+        str_match(this, src + begin, pattern);
+    }
+
+    return (result = REGEXP_MATCHED);
+}
+
 void regexp::insert(char *s) { insert(s, strlen(s)); }
 
 void regexp::insert(char *s, const unsigned int len) {
@@ -640,7 +1156,8 @@ char *regexp::previous_match(char *s, const int n) const {
     return s;
 }
 
-unsigned int regexp::count(const char *pattern) {
+template <typename _Tp>
+unsigned int regexp::count_of(const _Tp &pattern) {
     unsigned int count = 0;
 
     for (unsigned int index = 0; match(pattern, index) > 0 && index < src_len;
@@ -651,7 +1168,9 @@ unsigned int regexp::count(const char *pattern) {
     return count;
 }
 
-unsigned int regexp::global_match(const char *pattern, GlobalMatchCallback f) {
+template <typename _Tp>
+unsigned int regexp::global_match_of(const _Tp &pattern,
+                                     GlobalMatchCallback f) {
     unsigned int count = 0;
 
     for (unsigned int index = 0; match(pattern, index) > 0; count++) {
@@ -662,8 +1181,9 @@ unsigned int regexp::global_match(const char *pattern, GlobalMatchCallback f) {
     return count;
 }
 
-unsigned int regexp::replace(const char *pattern, GlobalReplaceCallback f,
-                             const unsigned int max_count) {
+template <typename _Tp>
+unsigned int regexp::replace_of(const _Tp &pattern, GlobalReplaceCallback f,
+                                const unsigned int max_count) {
     unsigned int count = 0;
 
     for (unsigned int index = 0; match(pattern, index) > 0 && index < src_len &&
@@ -696,8 +1216,9 @@ unsigned int regexp::replace(const char *pattern, GlobalReplaceCallback f,
     return count;
 }
 
-unsigned int regexp::replace(const char *pattern, const char *replacement,
-                             const unsigned int max_count) {
+template <typename _Tp>
+unsigned int regexp::replace_of(const _Tp &pattern, const char *replacement,
+                                const unsigned int max_count) {
     unsigned int count = 0;
     unsigned int replacement_length = strlen(replacement);
 
@@ -724,6 +1245,151 @@ unsigned int regexp::replace(const char *pattern, const char *replacement,
     src[src_len] = 0;
     return count;
 }
+class regexp_set
+/*
+Many patterns matched together: the regular ones share one lazily built
+DFA, which tells every pattern occurring in the input in a single pass.
+When each pattern has a literal every match must contain, an
+Aho-Corasick scan for those literals rejects most non-matching inputs
+before the DFA runs.
+*/
+{
+   private:
+    std::vector<regexp::program> patterns;
+    std::vector<int> fallback;
+    detail::__regexp_dfa dfa;
+    ex_string::aho_corasick prefilter;
+    bool filtered;
+
+    static std::string literal(const regexp::program &p)
+    /*
+    The longest run of single bytes every match of p contains.
+    */
+    {
+        std::string best, run;
+
+        for (size_t i = 0; i < p.items.size(); ++i) {
+            const detail::__regexp_inst &I = p.items[i];
+
+            if (I.op == detail::__regexp_inst::FRONTIER) continue;
+
+            bool single = I.op == detail::__regexp_inst::CONSUME &&
+                          (I.y == 0 || I.y == '+') && p.sets[I.x].count() == 1;
+
+            if (single) {
+                int c = 0;
+                while (!p.sets[I.x][c]) ++c;
+                run += (char)c;
+            }
+
+            if (!single || I.y == '+') {
+                if (run.size() > best.size()) best = run;
+                // A repeated byte still precedes what follows.
+                run = single ? run.substr(run.size() - 1) : std::string();
+            }
+        }
+
+        return run.size() > best.size() ? run : best;
+    }
+
+   public:
+    regexp_set() : filtered(false) {}
+
+    size_t size() const { return patterns.size(); }
+
+    int insert(const char *pattern)
+    /*
+    Add a pattern, returns its index, or a negative number on a parsing
+    error. Call build() after the last one.
+    */
+    {
+        regexp::program p(pattern);
+
+        if (p.status()) return p.status();
+
+        patterns.push_back(p);
+        return patterns.size() - 1;
+    }
+
+    void build() {
+        std::vector<int> begins;
+        std::vector<bool> unanchored;
+
+        dfa = detail::__regexp_dfa(), fallback.clear();
+        prefilter = ex_string::aho_corasick(), filtered = true;
+
+        for (size_t i = 0; i < patterns.size(); ++i) {
+            const regexp::program &p = patterns[i];
+            std::string lit = literal(p);
+
+            if (lit.empty())
+                filtered = false;
+            else
+                prefilter.insert(lit);
+
+            int frontiers = 0;
+
+            for (size_t j = 0; j < p.items.size(); ++j)
+                frontiers += p.items[j].op == detail::__regexp_inst::FRONTIER;
+
+            if (!p.regular || dfa.frontiers.size() + frontiers > 30) {
+                fallback.push_back(i);
+                continue;
+            }
+
+            std::vector<detail::__regexp_inst> items = p.items;
+            int base = dfa.sets.size();
+
+            for (size_t j = 0; j < items.size(); ++j)
+                if (items[j].op != detail::__regexp_inst::END)
+                    items[j].x += base;
+
+            dfa.sets.insert(dfa.sets.end(), p.sets.begin(), p.sets.end());
+            begins.push_back(dfa.append(items, i));
+            unanchored.push_back(!p.anchored);
+        }
+
+        dfa.assemble_all(begins, unanchored);
+        prefilter.build();
+    }
+
+    unsigned int match(const char *s, const unsigned int len,
+                       std::vector<int> &ids)
+    /*
+    Indices of the patterns matching somewhere in s, in ascending order;
+    returns how many.
+    */
+    {
+        ids.clear();
+
+        if (filtered && !prefilter.find(s, len)) return 0;
+
+        const detail::byte *p = (const detail::byte *)s;
+        int state = dfa.start(0);
+        bool matched;
+
+        for (unsigned int i = 0; i < len; ++i)
+            state = dfa.next(state, p[i], matched);
+
+        dfa.report(state, ids);
+
+        if (!fallback.empty()) {
+            regexp r((char *)s, len);
+
+            for (size_t i = 0; i < fallback.size(); ++i)
+                if (r.match(patterns[fallback[i]]) == REGEXP_MATCHED)
+                    ids.push_back(fallback[i]);
+
+            std::sort(ids.begin(), ids.end());
+        }
+
+        return ids.size();
+    }
+
+    unsigned int match(const char *s, std::vector<int> &ids) {
+        return match(s, strlen(s), ids);
+    }
+};
 }  // namespace Octinc
 
 #endif
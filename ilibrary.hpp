@@ -27,6 +27,7 @@ Junior Libraries
 #include "Junior/group.hpp" 
 #include "Junior/heap.hpp" 
 #include "Junior/huffman_tree.hpp" 
+#include "Junior/integer_set.hpp"
 #include "Junior/leftist_tree.hpp" 
 #include "Junior/linear_algebra.hpp"
 #include "Junior/linear_base.hpp"
@@ -38,6 +39,7 @@ Junior Libraries
 #include "Junior/peak.hpp" 
 #include "Junior/persistence_tree.hpp"
 #include "Junior/pointer_vector.hpp"
+#include "Junior/radix_heap.hpp"
 #include "Junior/random_access_set.hpp" 
 #include "Junior/RMQ.hpp" 
 #include "Junior/scapegoat_tree.hpp"
@@ -47,6 +49,7 @@ Junior Libraries
 #include "Junior/splay_tree.hpp"
 #include "Junior/statistics.hpp" 
 #include "Junior/thread_pool.hpp"
+#include "Junior/tiered_vector.hpp"
 #include "Junior/treap.hpp"
 #include "Junior/Trie.hpp"
 #include "Junior/tuple.hpp" 
@@ -59,6 +62,7 @@ Senior Libraries
 
 #include "Senior/arithmetic_coding.hpp" 
 #include "Senior/B_star.hpp"
+#include "Senior/b_plus_tree.hpp"
 #include "Senior/BigInteger.hpp"
 #include "Senior/BigDecimal.hpp"
 #include "Senior/ex_string.hpp"